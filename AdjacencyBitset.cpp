@@ -0,0 +1,105 @@
+#include "AdjacencyBitset.h"
+
+#include <algorithm>
+
+void AdjacencyBitset::assign(size_t numOfNodes)
+{
+	m_size = numOfNodes;
+	m_wordsPerRow = (numOfNodes + 63) / 64;
+	m_words.assign(m_size * m_wordsPerRow, 0);
+}
+
+void AdjacencyBitset::clear()
+{
+	m_words.clear();
+	m_words.shrink_to_fit();
+	m_size = 0;
+	m_wordsPerRow = 0;
+}
+
+unsigned int AdjacencyBitset::countRow(size_t row) const
+{
+	const std::uint64_t* words = getRow(row);
+	unsigned int count = 0;
+	for (size_t w = 0; w < m_wordsPerRow; ++w)
+	{
+		count += std::popcount(words[w]);
+	}
+	return count;
+}
+
+unsigned int AdjacencyBitset::countColumn(size_t column) const
+{
+	unsigned int count = 0;
+	for (size_t row = 0; row < m_size; ++row)
+	{
+		count += test(row, column) ? 1 : 0;
+	}
+	return count;
+}
+
+unsigned int AdjacencyBitset::countCommon(size_t row1, size_t row2) const
+{
+	const std::uint64_t* words1 = getRow(row1);
+	const std::uint64_t* words2 = getRow(row2);
+	unsigned int count = 0;
+	for (size_t w = 0; w < m_wordsPerRow; ++w)
+	{
+		count += std::popcount(words1[w] & words2[w]);
+	}
+	return count;
+}
+
+void AdjacencyBitset::addNode()
+{
+	reserveColumns(m_size + 1);
+	// Bits past the last column are always clear, so the new row and column are empty already once allocated.
+	m_words.resize((m_size + 1) * m_wordsPerRow, 0);
+	m_size++;
+}
+
+void AdjacencyBitset::swapRemove(size_t index)
+{
+	const size_t last = m_size - 1;
+	if (index != last)
+	{
+		std::copy(getRow(last), getRow(last) + m_wordsPerRow, m_words.begin() + index * m_wordsPerRow);
+		for (size_t row = 0; row < last; ++row)
+		{
+			if (test(row, last))
+			{
+				set(row, index);
+			}
+			else
+			{
+				reset(row, index);
+			}
+		}
+		// The moved row may have pointed at the removed node, that entry now sits at (index, index).
+		reset(index, index);
+	}
+	for (size_t row = 0; row < last; ++row)
+	{
+		reset(row, last);
+	}
+	m_size--;
+	m_words.resize(m_size * m_wordsPerRow);
+}
+
+void AdjacencyBitset::reserveColumns(size_t numOfColumns)
+{
+	const size_t wordsNeeded = (numOfColumns + 63) / 64;
+	if (wordsNeeded <= m_wordsPerRow)
+	{
+		return;
+	}
+
+	const size_t wordsPerRow = std::max(wordsNeeded, 2 * m_wordsPerRow);
+	std::vector<std::uint64_t> words(m_size * wordsPerRow, 0);
+	for (size_t row = 0; row < m_size; ++row)
+	{
+		std::copy(getRow(row), getRow(row) + m_wordsPerRow, words.begin() + row * wordsPerRow);
+	}
+	m_words.swap(words);
+	m_wordsPerRow = wordsPerRow;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Adjacency matrix with one bit per entry, rows stored back to back as 64-bit words in a single allocation.
+// Bit j of row i is set if the edge i -> j exists. Tests are O(1), row counts and row intersections are popcounts over
+// N / 64 words. Costs N^2 / 8 bytes, 32 times less than a matrix of ints, so it pays off for dense graphs.
+// Weights are not stored here, the graph keeps them with the edges.
+class AdjacencyBitset
+{
+public:
+	// Resets to numOfNodes nodes without edges.
+	void assign(size_t numOfNodes);
+	// Frees the memory.
+	void clear();
+
+	size_t size() const { return m_size; }
+	size_t getWordsPerRow() const { return m_wordsPerRow; }
+	size_t getMemoryUsage() const { return m_words.capacity() * sizeof(std::uint64_t); }
+
+	bool test(size_t row, size_t column) const
+	{
+		return (m_words[row * m_wordsPerRow + column / 64] >> (column % 64)) & 1u;
+	}
+	void set(size_t row, size_t column)
+	{
+		m_words[row * m_wordsPerRow + column / 64] |= std::uint64_t(1) << (column % 64);
+	}
+	void reset(size_t row, size_t column)
+	{
+		m_words[row * m_wordsPerRow + column / 64] &= ~(std::uint64_t(1) << (column % 64));
+	}
+	const std::uint64_t* getRow(size_t row) const { return m_words.data() + row * m_wordsPerRow; }
+
+	// Out-degree of row, O(N / 64).
+	unsigned int countRow(size_t row) const;
+	// In-degree of column, O(N).
+	unsigned int countColumn(size_t column) const;
+	// Number of columns set in both rows (common out-neighbors), O(N / 64).
+	unsigned int countCommon(size_t row1, size_t row2) const;
+
+	// Adds an empty row and column. Rows are padded to a capacity that doubles, so this is amortized O(N / 64).
+	void addNode();
+	// Moves row and column size() - 1 into index, like the removal of a node. O(N).
+	void swapRemove(size_t index);
+
+private:
+	void reserveColumns(size_t numOfColumns);
+
+	std::vector<std::uint64_t> m_words;
+	size_t m_size = 0;
+	size_t m_wordsPerRow = 0;
+};
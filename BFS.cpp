@@ -0,0 +1,230 @@
+#include "BFS.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace BFS
+{
+	namespace
+	{
+		// Beamer's switching thresholds: bottom-up once the frontier has more than 1/ALPHA of the unexplored edges,
+		// back to top-down once a shrinking frontier holds fewer than 1/BETA of the nodes.
+		constexpr unsigned long long ALPHA = 15;
+		constexpr size_t BETA = 18;
+		constexpr size_t WORDS_PER_CHUNK = 16;	// Bottom-up chunks of 1024 nodes, every chunk owns its bitmap words.
+
+		// The parents of a level are only written through this, -1 counting as larger than any node.
+		void SetParentToMinimum(int& parent, int candidate)
+		{
+			std::atomic_ref<int> ref(parent);
+			int current = ref.load(std::memory_order_relaxed);
+			while ((current < 0 || candidate < current) && !ref.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+			{
+			}
+		}
+	}
+
+	Search::Search(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency, const std::vector<unsigned int>& sources)
+		: m_out{ outAdjacency },
+		  m_in{ inAdjacency },
+		  m_pool{ ThreadPool::getGlobal() }
+	{
+		const size_t numOfNodes = m_out.offsets.size() - 1;
+		m_result.distances.assign(numOfNodes, UNREACHED);
+		m_result.parents.assign(numOfNodes, -1);
+		m_frontierBits.assign((numOfNodes + 63) / 64, 0);
+		m_nextBits.assign(m_frontierBits.size(), 0);
+		m_found.resize(m_pool.getNumOfThreads());
+		m_foundEdges.resize(m_pool.getNumOfThreads());
+		m_unexploredEdges = m_out.neighbors.size();
+
+		for (unsigned int source : sources)
+		{
+			if (source >= numOfNodes)
+				throw std::invalid_argument("Source node of the BFS does not exist!");
+
+			if (m_result.distances[source] == 0)
+			{
+				continue;
+			}
+			m_result.distances[source] = 0;
+			m_result.parents[source] = static_cast<int>(source);
+			m_frontier.push_back(source);
+			m_frontierEdges += m_out.degree(source);
+		}
+		m_unexploredEdges -= m_frontierEdges;
+		m_result.numOfReached = m_frontier.size();
+		m_result.numOfLevels = m_frontier.empty() ? 0 : 1;
+	}
+
+	Search::Search(const Graph& graph, unsigned int source)
+		: Search{ graph.getOutAdjacency(), graph.getInAdjacency(), { source } }
+	{
+	}
+
+	bool Search::step()
+	{
+		if (m_frontier.empty())
+		{
+			return false;
+		}
+
+		const size_t numOfNodes = m_result.distances.size();
+		const bool growing = m_frontier.size() >= m_previousFrontierSize;
+		if (!m_bottomUp && growing && m_frontierEdges > m_unexploredEdges / ALPHA)
+		{
+			m_bottomUp = true;
+			buildFrontierBits();
+		}
+		else if (m_bottomUp && !growing && m_frontier.size() < numOfNodes / BETA)
+		{
+			m_bottomUp = false;
+		}
+
+		for (size_t t = 0; t < m_found.size(); ++t)
+		{
+			m_found[t].clear();
+			m_foundEdges[t] = 0;
+		}
+		if (m_bottomUp)
+		{
+			stepBottomUp();
+		}
+		else
+		{
+			stepTopDown();
+		}
+
+		m_previousFrontierSize = m_frontier.size();
+		gatherFrontier();
+		m_level++;
+		if (!m_frontier.empty())
+		{
+			m_result.numOfLevels = m_level + 1;
+		}
+		return true;
+	}
+
+	void Search::stepTopDown()
+	{
+		const unsigned int nextLevel = m_level + 1;
+		m_pool.parallelFor(0, m_frontier.size(), [&](size_t begin, size_t end, unsigned int threadIndex)
+			{
+				std::vector<unsigned int>& found = m_found[threadIndex];
+				unsigned long long foundEdges = 0;
+				for (size_t f = begin; f < end; ++f)
+				{
+					const unsigned int u = m_frontier[f];
+					for (unsigned int k = m_out.offsets[u]; k < m_out.offsets[u + 1]; ++k)
+					{
+						const unsigned int v = m_out.neighbors[k];
+						std::atomic_ref<unsigned int> distance(m_result.distances[v]);
+						unsigned int current = distance.load(std::memory_order_relaxed);
+						if (current != UNREACHED && current != nextLevel)
+						{
+							continue;
+						}
+
+						// Whoever claims v adds it to the next frontier, every frontier node reaching it competes for parent.
+						if (current == UNREACHED && distance.compare_exchange_strong(current, nextLevel, std::memory_order_relaxed))
+						{
+							found.push_back(v);
+							foundEdges += m_out.degree(v);
+						}
+						else if (current != nextLevel)
+						{
+							continue;
+						}
+						SetParentToMinimum(m_result.parents[v], static_cast<int>(u));
+					}
+				}
+				m_foundEdges[threadIndex] += foundEdges;
+			}, 64);
+	}
+
+	void Search::stepBottomUp()
+	{
+		const unsigned int nextLevel = m_level + 1;
+		const size_t numOfNodes = m_result.distances.size();
+		const size_t numOfWords = m_frontierBits.size();
+		m_pool.parallelFor(0, numOfWords, [&](size_t beginWord, size_t endWord, unsigned int threadIndex)
+			{
+				std::vector<unsigned int>& found = m_found[threadIndex];
+				unsigned long long foundEdges = 0;
+				for (size_t w = beginWord; w < endWord; ++w)
+				{
+					std::uint64_t nextWord = 0;
+					const size_t endNode = std::min(64 * w + 64, numOfNodes);
+					for (size_t v = 64 * w; v < endNode; ++v)
+					{
+						if (m_result.distances[v] != UNREACHED)
+						{
+							continue;
+						}
+						// In-neighbors are sorted, so the first one in the frontier is the smallest.
+						for (unsigned int k = m_in.offsets[v]; k < m_in.offsets[v + 1]; ++k)
+						{
+							const unsigned int u = m_in.neighbors[k];
+							if ((m_frontierBits[u / 64] >> (u % 64)) & 1u)
+							{
+								m_result.distances[v] = nextLevel;
+								m_result.parents[v] = static_cast<int>(u);
+								nextWord |= std::uint64_t(1) << (v % 64);
+								found.push_back(static_cast<unsigned int>(v));
+								foundEdges += m_out.degree(v);
+								break;
+							}
+						}
+					}
+					m_nextBits[w] = nextWord;
+				}
+				m_foundEdges[threadIndex] += foundEdges;
+			}, WORDS_PER_CHUNK);
+		m_frontierBits.swap(m_nextBits);
+	}
+
+	void Search::buildFrontierBits()
+	{
+		std::fill(m_frontierBits.begin(), m_frontierBits.end(), 0);
+		for (unsigned int u : m_frontier)
+		{
+			m_frontierBits[u / 64] |= std::uint64_t(1) << (u % 64);
+		}
+	}
+
+	void Search::gatherFrontier()
+	{
+		m_frontier.clear();
+		m_frontierEdges = 0;
+		for (size_t t = 0; t < m_found.size(); ++t)
+		{
+			m_frontier.insert(m_frontier.end(), m_found[t].begin(), m_found[t].end());
+			m_frontierEdges += m_foundEdges[t];
+		}
+		m_unexploredEdges -= m_frontierEdges;
+		m_result.numOfReached += m_frontier.size();
+	}
+
+	Result Run(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency, const std::vector<unsigned int>& sources)
+	{
+		Search search{ outAdjacency, inAdjacency, sources };
+		while (search.step())
+		{
+		}
+		return search.takeResult();
+	}
+
+	Result Run(const Graph& graph, unsigned int source)
+	{
+		return Run(graph.getOutAdjacency(), graph.getInAdjacency(), { source });
+	}
+
+	void ColorFrontier(Graph& graph, const Search& search, sf::Color color)
+	{
+		for (unsigned int node : search.getFrontier())
+		{
+			graph.setNodeColor(node, color);
+		}
+	}
+}
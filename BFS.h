@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Graph.h"
+#include "SparseMatrix.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// Breadth-first search along the edge directions, direction-optimizing (Beamer, Asanovic and Patterson,
+// "Direction-Optimizing Breadth-First Search"). While the frontier is small a level is expanded top-down, the frontier
+// pushing along its out-edges. Once it is large, bottom-up: every unvisited node looks along its in-edges for a parent
+// in the frontier, which is kept as a bitmap, and stops at the first one. Both run on the global thread pool.
+// Distances and parents do not depend on the number of threads: the parent of a node is the in-neighbor with the
+// smallest index one level closer to the sources (rows of the adjacency are sorted, as in Graph).
+namespace BFS
+{
+	constexpr unsigned int UNREACHED = ~0u;
+
+	struct Result
+	{
+		std::vector<unsigned int> distances;	// Hops from the nearest source, UNREACHED if not reachable.
+		std::vector<int> parents;				// Previous node on a shortest path, the node itself for sources, -1 if not reached.
+		unsigned int numOfLevels = 0;			// Largest distance + 1.
+		size_t numOfReached = 0;
+	};
+
+	// A search advanced one level at a time, so a simulation can run a level per step and show the frontier as it
+	// moves (see ColorFrontier). The adjacency must not change while the search is in progress.
+	class Search
+	{
+	public:
+		// Throws std::invalid_argument if a source does not exist.
+		Search(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency, const std::vector<unsigned int>& sources);
+		Search(const Graph& graph, unsigned int source);
+
+		// Expands the frontier by one level. Returns false, doing nothing, once the frontier is empty.
+		bool step();
+		bool isDone() const { return m_frontier.empty(); }
+		// Nodes at distance getLevel(), in no particular order.
+		const std::vector<unsigned int>& getFrontier() const { return m_frontier; }
+		unsigned int getLevel() const { return m_level; }
+		// Whether the last level was expanded bottom-up.
+		bool wasBottomUp() const { return m_bottomUp; }
+		const Result& getResult() const { return m_result; }
+		Result takeResult() { return std::move(m_result); }
+
+	private:
+		void stepTopDown();
+		void stepBottomUp();
+		void buildFrontierBits();
+		void gatherFrontier();
+
+		const CompressedAdjacency& m_out;
+		const CompressedAdjacency& m_in;
+		ThreadPool& m_pool;
+		Result m_result;
+
+		std::vector<unsigned int> m_frontier;
+		std::vector<std::uint64_t> m_frontierBits;			// Valid while expanding bottom-up.
+		std::vector<std::uint64_t> m_nextBits;
+		std::vector<std::vector<unsigned int>> m_found;		// Per thread: nodes of the next level.
+		std::vector<unsigned long long> m_foundEdges;		// Per thread: out-degrees of those nodes.
+
+		unsigned int m_level = 0;
+		bool m_bottomUp = false;
+		size_t m_previousFrontierSize = 0;
+		unsigned long long m_frontierEdges = 0;			// Out-edges of the frontier.
+		unsigned long long m_unexploredEdges = 0;		// Out-edges of the nodes not reached yet.
+	};
+
+	Result Run(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency, const std::vector<unsigned int>& sources);
+	Result Run(const Graph& graph, unsigned int source);
+
+	// Colors the current frontier of a search, e.g. right after step() in Simulation::onStep.
+	void ColorFrontier(Graph& graph, const Search& search, sf::Color color = sf::Color::Yellow);
+}
@@ -0,0 +1,310 @@
+#include "Betweenness.h"
+#include "RadixHeap.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <memory>
+
+namespace Betweenness
+{
+	namespace
+	{
+		using ShortestPaths::Distance;
+		using ShortestPaths::UNREACHABLE;
+
+		constexpr size_t NUM_OF_PROGRESS_REPORTS = 100;
+
+		// Sums of non-negative values up to maximumValue each. Every value is rounded to a fixed point number that fits
+		// 63 bits and added to a 128 bit total with atomics, the carry taken over by hand. Integer additions give the
+		// same total in any order.
+		class FixedPointSums
+		{
+		public:
+			FixedPointSums(size_t size, double maximumValue)
+				: m_low(size, 0),
+				  m_high(size, 0)
+			{
+				const int integerBits = std::bit_width(static_cast<std::uint64_t>(std::ceil(std::max(maximumValue, 1.0))));
+				m_scale = std::ldexp(1.0, std::max(63 - integerBits, 0));
+			}
+
+			void add(size_t index, double value)
+			{
+				const std::uint64_t term = static_cast<std::uint64_t>(value * m_scale + 0.5);
+				if (term == 0)
+				{
+					return;
+				}
+				const std::uint64_t old = std::atomic_ref<std::uint64_t>(m_low[index]).fetch_add(term, std::memory_order_relaxed);
+				if (old + term < old)
+				{
+					std::atomic_ref<std::uint64_t>(m_high[index]).fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+			double get(size_t index) const
+			{
+				return (std::ldexp(static_cast<double>(m_high[index]), 64) + static_cast<double>(m_low[index])) / m_scale;
+			}
+
+		private:
+			std::vector<std::uint64_t> m_low;
+			std::vector<std::uint64_t> m_high;
+			double m_scale = 1.0;
+		};
+
+		// Buffers of one thread, reset after every source in time proportional to what it reached.
+		struct Workspace
+		{
+			explicit Workspace(size_t numOfNodes)
+				: distances(numOfNodes, UNREACHABLE),
+				  pathCounts(numOfNodes, 0.0),
+				  dependencies(numOfNodes, 0.0)
+			{
+			}
+
+			std::vector<Distance> distances;
+			std::vector<double> pathCounts;		// Number of shortest paths from the source, as double: it grows exponentially.
+			std::vector<double> dependencies;
+			std::vector<unsigned int> order;	// Reached nodes by non-decreasing distance.
+			RadixHeap heap;
+		};
+
+		// Fills order, distances and path counts for one source: BFS without weights, Dijkstra with.
+		void Search(const ShortestPaths::WeightedAdjacency& adjacency, unsigned int source, Workspace& workspace)
+		{
+			std::vector<Distance>& distances = workspace.distances;
+			std::vector<double>& pathCounts = workspace.pathCounts;
+			std::vector<unsigned int>& order = workspace.order;
+			distances[source] = 0;
+			pathCounts[source] = 1.0;
+
+			if (adjacency.weights.empty())
+			{
+				order.push_back(source);
+				for (size_t i = 0; i < order.size(); ++i)
+				{
+					const unsigned int u = order[i];
+					const Distance next = distances[u] + 1;
+					for (unsigned int k = adjacency.offsets[u]; k < adjacency.offsets[u + 1]; ++k)
+					{
+						const unsigned int v = adjacency.neighbors[k];
+						if (distances[v] == UNREACHABLE)
+						{
+							distances[v] = next;
+							order.push_back(v);
+						}
+						if (distances[v] == next)
+						{
+							pathCounts[v] += pathCounts[u];
+						}
+					}
+				}
+				return;
+			}
+
+			// Positive weights: all predecessors of a node are settled before it, so its count is final when popped.
+			workspace.heap.push(0, source);
+			while (!workspace.heap.empty())
+			{
+				const auto [key, u] = workspace.heap.pop();
+				if (static_cast<Distance>(key) != distances[u])
+				{
+					continue;
+				}
+				order.push_back(u);
+				for (unsigned int k = adjacency.offsets[u]; k < adjacency.offsets[u + 1]; ++k)
+				{
+					const unsigned int v = adjacency.neighbors[k];
+					const Distance candidate = distances[u] + adjacency.weights[k];
+					if (candidate < distances[v])
+					{
+						distances[v] = candidate;
+						pathCounts[v] = pathCounts[u];
+						workspace.heap.push(static_cast<std::uint64_t>(candidate), v);
+					}
+					else if (candidate == distances[v])
+					{
+						pathCounts[v] += pathCounts[u];
+					}
+				}
+			}
+		}
+
+		// Dependencies of the source on every node it reached, from the farthest back. A successor v of w on a
+		// shortest path passes on (1 + dependency of v) in proportion to the paths through w, pathCounts[w] / pathCounts[v].
+		template<typename Visit>
+		void Accumulate(const ShortestPaths::WeightedAdjacency& adjacency, unsigned int source, Workspace& workspace, const Visit& visit)
+		{
+			const bool weighted = !adjacency.weights.empty();
+			for (size_t i = workspace.order.size(); i-- > 0;)
+			{
+				const unsigned int w = workspace.order[i];
+				double sum = 0.0;
+				for (unsigned int k = adjacency.offsets[w]; k < adjacency.offsets[w + 1]; ++k)
+				{
+					const unsigned int v = adjacency.neighbors[k];
+					if (workspace.distances[v] == workspace.distances[w] + (weighted ? adjacency.weights[k] : 1))
+					{
+						sum += (1.0 + workspace.dependencies[v]) / workspace.pathCounts[v];
+					}
+				}
+				workspace.dependencies[w] = workspace.pathCounts[w] * sum;
+				if (w != source)
+				{
+					visit(w, workspace.dependencies[w]);
+				}
+			}
+
+			for (unsigned int node : workspace.order)
+			{
+				workspace.distances[node] = UNREACHABLE;
+				workspace.pathCounts[node] = 0.0;
+				workspace.dependencies[node] = 0.0;
+			}
+			workspace.order.clear();
+			workspace.heap.clear();
+		}
+
+		// numOfSamples distinct nodes, by a partial Fisher-Yates shuffle, sorted.
+		std::vector<unsigned int> SampleSources(size_t numOfNodes, size_t numOfSamples, std::uint64_t seed)
+		{
+			std::vector<unsigned int> nodes(numOfNodes);
+			for (size_t n = 0; n < numOfNodes; ++n)
+			{
+				nodes[n] = static_cast<unsigned int>(n);
+			}
+			Philox rng{ seed };
+			for (size_t i = 0; i < numOfSamples; ++i)
+			{
+				const size_t j = i + rng.nextBelow(static_cast<std::uint32_t>(numOfNodes - i));
+				std::swap(nodes[i], nodes[j]);
+			}
+			nodes.resize(numOfSamples);
+			std::sort(nodes.begin(), nodes.end());
+			return nodes;
+		}
+
+		sf::Color Mix(sf::Color a, sf::Color b, float t)
+		{
+			auto channel = [t](std::uint8_t x, std::uint8_t y) { return static_cast<std::uint8_t>(x + (static_cast<float>(y) - x) * t); };
+			return sf::Color(channel(a.r, b.r), channel(a.g, b.g), channel(a.b, b.b));
+		}
+	}
+
+	Result Run(const Graph& graph, const Options& options)
+	{
+		if (options.weighted)
+		{
+			return Run(ShortestPaths::BuildWeightedAdjacency(graph), options);
+		}
+
+		const CompressedAdjacency& out = graph.getOutAdjacency();
+		ShortestPaths::WeightedAdjacency adjacency;
+		adjacency.offsets = out.offsets;
+		adjacency.neighbors = out.neighbors;
+		adjacency.edges = out.edges;
+		return Run(adjacency, options);
+	}
+
+	Result Run(const ShortestPaths::WeightedAdjacency& adjacency, const Options& options)
+	{
+		const size_t numOfNodes = adjacency.getNumOfNodes();
+		const bool sampled = options.numOfSamples > 0 && options.numOfSamples < numOfNodes;
+		std::vector<unsigned int> sources;
+		if (sampled)
+		{
+			sources = SampleSources(numOfNodes, options.numOfSamples, options.seed);
+		}
+		else
+		{
+			sources.resize(numOfNodes);
+			for (size_t n = 0; n < numOfNodes; ++n)
+			{
+				sources[n] = static_cast<unsigned int>(n);
+			}
+		}
+
+		// A dependency is at most the number of other targets, N - 2.
+		const double maximumDependency = static_cast<double>(numOfNodes);
+		FixedPointSums sums(numOfNodes, maximumDependency);
+		std::unique_ptr<FixedPointSums> squareSums;
+		if (sampled)
+		{
+			squareSums = std::make_unique<FixedPointSums>(numOfNodes, maximumDependency * maximumDependency);
+		}
+
+		// Sources run in rounds, so progress is reported from the calling thread between them.
+		ThreadPool& pool = ThreadPool::getGlobal();
+		std::vector<std::unique_ptr<Workspace>> workspaces(pool.getNumOfThreads());
+		const size_t sourcesPerRound = std::max<size_t>((sources.size() + NUM_OF_PROGRESS_REPORTS - 1) / NUM_OF_PROGRESS_REPORTS, 4 * pool.getNumOfThreads());
+		for (size_t roundBegin = 0; roundBegin < sources.size(); roundBegin += sourcesPerRound)
+		{
+			const size_t roundEnd = std::min(roundBegin + sourcesPerRound, sources.size());
+			pool.parallelFor(roundBegin, roundEnd, [&](size_t begin, size_t end, unsigned int threadIndex)
+				{
+					if (!workspaces[threadIndex])
+					{
+						workspaces[threadIndex] = std::make_unique<Workspace>(numOfNodes);
+					}
+					Workspace& workspace = *workspaces[threadIndex];
+					for (size_t i = begin; i < end; ++i)
+					{
+						Search(adjacency, sources[i], workspace);
+						Accumulate(adjacency, sources[i], workspace, [&](unsigned int node, double dependency)
+							{
+								sums.add(node, dependency);
+								if (squareSums)
+								{
+									squareSums->add(node, dependency * dependency);
+								}
+							});
+					}
+				}, 1);
+
+			if (options.progress)
+			{
+				options.progress(roundEnd, sources.size());
+			}
+		}
+
+		Result result;
+		result.numOfSources = sources.size();
+		result.centrality.resize(numOfNodes);
+		const double k = static_cast<double>(sources.size());
+		const double n = static_cast<double>(numOfNodes);
+		const double scale = (sampled ? n / k : 1.0) / (options.normalized && numOfNodes > 2 ? (n - 1.0) * (n - 2.0) : 1.0);
+		for (size_t v = 0; v < numOfNodes; ++v)
+		{
+			result.centrality[v] = sums.get(v) * scale;
+		}
+
+		if (sampled)
+		{
+			// The estimate is N times the mean dependency over the sample.
+			result.standardErrors.resize(numOfNodes);
+			const double finitePopulation = k > 1.0 ? (1.0 - k / n) / (k * (k - 1.0)) : 0.0;
+			for (size_t v = 0; v < numOfNodes; ++v)
+			{
+				const double sum = sums.get(v);
+				const double squaredDeviations = std::max(squareSums->get(v) - sum * sum / k, 0.0);
+				result.standardErrors[v] = std::sqrt(squaredDeviations * finitePopulation) * scale * k;
+			}
+		}
+		return result;
+	}
+
+	void ColorByCentrality(Graph& graph, const Result& result, sf::Color low, sf::Color high)
+	{
+		const double maximum = result.centrality.empty() ? 0.0 : *std::max_element(result.centrality.begin(), result.centrality.end());
+		for (int n = 0; n < graph.getNumOfNodes(); ++n)
+		{
+			const float t = maximum > 0.0 ? static_cast<float>(std::sqrt(result.centrality[n] / maximum)) : 0.0f;
+			graph.setNodeColor(n, Mix(low, high, t));
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Graph.h"
+#include "ShortestPaths.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Betweenness centrality by Brandes' algorithm: a shortest path search from every source, then the dependencies of
+// the source on every node accumulated backwards in order of decreasing distance. Paths follow the edge directions.
+// Sources run in parallel, every thread with its own O(N) buffers. The sums are kept in fixed point, so the result
+// does not depend on the number of threads.
+// O(N * M) unweighted, O(N * (M + N log C)) weighted, for the largest weight C. Sampling k sources takes k / N of that.
+namespace Betweenness
+{
+	struct Options
+	{
+		bool weighted = false;			// Path lengths are Edge::weight, which must then be positive. Otherwise hops.
+		// 0 for the exact centrality. Otherwise the centrality is estimated from this many sources, sampled uniformly
+		// without repetition, and scaled up by N / numOfSamples.
+		unsigned int numOfSamples = 0;
+		std::uint64_t seed = 0;			// Same seed, same sampled sources.
+		bool normalized = false;		// Divides by (N - 1)(N - 2), the number of ordered pairs a node can be between.
+		// Called from the calling thread with the number of sources done so far, about a hundred times per run.
+		std::function<void(size_t done, size_t total)> progress;
+	};
+
+	struct Result
+	{
+		std::vector<double> centrality;
+		// Sampled runs only: standard error of every estimate, from the spread of the dependencies over the sampled
+		// sources (with the correction for sampling without repetition). Empty for exact runs.
+		std::vector<double> standardErrors;
+		size_t numOfSources = 0;
+	};
+
+	// Throws std::invalid_argument if weighted and a weight is not positive.
+	Result Run(const Graph& graph, const Options& options = {});
+	// Weighted if adjacency.weights is filled, options.weighted is not used.
+	Result Run(const ShortestPaths::WeightedAdjacency& adjacency, const Options& options = {});
+
+	// Colors every node between low and high by its centrality, on a square root scale so the few central nodes do
+	// not wash out the rest.
+	void ColorByCentrality(Graph& graph, const Result& result, sf::Color low = sf::Color::Blue, sf::Color high = sf::Color::Yellow);
+}
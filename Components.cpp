@@ -0,0 +1,361 @@
+#include "Components.h"
+#include "BFS.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Components
+{
+	namespace
+	{
+		constexpr unsigned int NONE = ~0u;
+		constexpr size_t NODES_PER_CHUNK = 4096;
+		constexpr unsigned int NEIGHBOR_ROUNDS = 2;		// Afforest: neighbors linked by every node before sampling.
+		constexpr unsigned int NUM_SAMPLES = 1024;		// Nodes sampled to find the largest intermediate component.
+		constexpr std::uint64_t SAMPLE_SEED = 0x5eed;
+
+		unsigned int Load(const unsigned int& value)
+		{
+			return std::atomic_ref<const unsigned int>(value).load(std::memory_order_relaxed);
+		}
+
+		// Union of the trees of u and v. The larger root is hooked under the smaller one, so the root of every tree
+		// is its smallest node, whatever the order in which the links happen.
+		void Link(unsigned int u, unsigned int v, std::vector<unsigned int>& parents)
+		{
+			unsigned int p1 = Load(parents[u]);
+			unsigned int p2 = Load(parents[v]);
+			while (p1 != p2)
+			{
+				const unsigned int high = std::max(p1, p2);
+				const unsigned int low = std::min(p1, p2);
+				unsigned int parentOfHigh = Load(parents[high]);
+				if (parentOfHigh == low)
+				{
+					break;
+				}
+				if (parentOfHigh == high
+					&& std::atomic_ref<unsigned int>(parents[high]).compare_exchange_strong(parentOfHigh, low, std::memory_order_relaxed))
+				{
+					break;
+				}
+				p1 = Load(parents[Load(parents[high])]);
+				p2 = Load(parents[low]);
+			}
+		}
+
+		// Points every node straight at its root.
+		void Compress(std::vector<unsigned int>& parents)
+		{
+			ThreadPool::getGlobal().parallelFor(0, parents.size(), [&](size_t begin, size_t end, unsigned int)
+				{
+					for (size_t n = begin; n < end; ++n)
+					{
+						unsigned int parent = Load(parents[n]);
+						unsigned int grandparent = Load(parents[parent]);
+						while (parent != grandparent)
+						{
+							parent = grandparent;
+							grandparent = Load(parents[parent]);
+						}
+						std::atomic_ref<unsigned int>(parents[n]).store(parent, std::memory_order_relaxed);
+					}
+				}, NODES_PER_CHUNK);
+		}
+
+		// Most frequent root among randomly sampled nodes, the smallest one on ties.
+		unsigned int SampleFrequentRoot(const std::vector<unsigned int>& parents)
+		{
+			Philox rng{ SAMPLE_SEED };
+			std::unordered_map<unsigned int, unsigned int> counts;
+			for (unsigned int i = 0; i < NUM_SAMPLES; ++i)
+			{
+				counts[parents[rng.nextBelow(static_cast<std::uint32_t>(parents.size()))]]++;
+			}
+			std::pair<unsigned int, unsigned int> best{ NONE, 0 };
+			for (const auto& [root, count] : counts)
+			{
+				if (count > best.second || (count == best.second && root < best.first))
+				{
+					best = { root, count };
+				}
+			}
+			return best.first;
+		}
+
+		// Labels from the smallest node of every component, which is never larger than the node itself.
+		Result Finalize(const std::vector<unsigned int>& representatives)
+		{
+			Result result;
+			result.labels.resize(representatives.size());
+			for (size_t n = 0; n < representatives.size(); ++n)
+			{
+				if (representatives[n] == n)
+				{
+					result.labels[n] = static_cast<unsigned int>(result.sizes.size());
+					result.sizes.push_back(0);
+				}
+				else
+				{
+					result.labels[n] = result.labels[representatives[n]];
+				}
+				result.sizes[result.labels[n]]++;
+			}
+			return result;
+		}
+
+		// Tarjan's algorithm with an explicit stack, over the nodes that have no representative yet.
+		void Tarjan(const CompressedAdjacency& outAdjacency, std::vector<unsigned int>& representatives)
+		{
+			const size_t numOfNodes = representatives.size();
+			std::vector<unsigned int> order(numOfNodes, NONE);		// Discovery index.
+			std::vector<unsigned int> lowLinks(numOfNodes, 0);
+			std::vector<unsigned char> onStack(numOfNodes, 0);
+			std::vector<unsigned int> stack;
+			std::vector<std::pair<unsigned int, unsigned int>> calls;	// Node and its next out-entry.
+			unsigned int counter = 0;
+
+			auto visit = [&](unsigned int node)
+				{
+					order[node] = lowLinks[node] = counter++;
+					stack.push_back(node);
+					onStack[node] = 1;
+					calls.emplace_back(node, outAdjacency.offsets[node]);
+				};
+
+			for (unsigned int root = 0; root < numOfNodes; ++root)
+			{
+				if (representatives[root] != NONE || order[root] != NONE)
+				{
+					continue;
+				}
+
+				visit(root);
+				while (!calls.empty())
+				{
+					const unsigned int u = calls.back().first;
+					unsigned int& k = calls.back().second;
+					if (k < outAdjacency.offsets[u + 1])
+					{
+						const unsigned int v = outAdjacency.neighbors[k++];
+						// Nodes with a representative from before are complete components of their own.
+						if (order[v] == NONE && representatives[v] == NONE)
+						{
+							visit(v);
+						}
+						else if (onStack[v])
+						{
+							lowLinks[u] = std::min(lowLinks[u], order[v]);
+						}
+						continue;
+					}
+
+					calls.pop_back();
+					if (!calls.empty())
+					{
+						const unsigned int parent = calls.back().first;
+						lowLinks[parent] = std::min(lowLinks[parent], lowLinks[u]);
+					}
+					if (lowLinks[u] == order[u])
+					{
+						auto first = std::find(stack.rbegin(), stack.rend(), u).base() - 1;
+						const unsigned int smallest = *std::min_element(first, stack.end());
+						for (auto it = first; it != stack.end(); ++it)
+						{
+							representatives[*it] = smallest;
+							onStack[*it] = 0;
+						}
+						stack.erase(first, stack.end());
+					}
+				}
+			}
+		}
+
+		sf::Color ComponentColor(unsigned int label)
+		{
+			// Hues a golden angle apart, so neighboring labels look different.
+			const float hue = std::fmod(static_cast<float>(label) * 0.618034f, 1.0f) * 6.0f;
+			const float saturation = 0.7f;
+			const float fraction = hue - std::floor(hue);
+			const float low = 1.0f - saturation;
+			const float falling = 1.0f - saturation * fraction;
+			const float rising = 1.0f - saturation * (1.0f - fraction);
+			float r = 1.0f, g = 1.0f, b = 1.0f;
+			switch (static_cast<int>(hue) % 6)
+			{
+			case 0: r = 1.0f; g = rising; b = low; break;
+			case 1: r = falling; g = 1.0f; b = low; break;
+			case 2: r = low; g = 1.0f; b = rising; break;
+			case 3: r = low; g = falling; b = 1.0f; break;
+			case 4: r = rising; g = low; b = 1.0f; break;
+			default: r = 1.0f; g = low; b = falling; break;
+			}
+			return sf::Color(static_cast<std::uint8_t>(255 * r), static_cast<std::uint8_t>(255 * g), static_cast<std::uint8_t>(255 * b));
+		}
+	}
+
+	unsigned int Result::getLargest() const
+	{
+		return sizes.empty() ? 0 : static_cast<unsigned int>(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> Result::getSizeHistogram() const
+	{
+		std::vector<unsigned int> sorted = sizes;
+		std::sort(sorted.begin(), sorted.end());
+		std::vector<std::pair<unsigned int, unsigned int>> histogram;
+		for (unsigned int size : sorted)
+		{
+			if (histogram.empty() || histogram.back().first != size)
+			{
+				histogram.emplace_back(size, 0);
+			}
+			histogram.back().second++;
+		}
+		return histogram;
+	}
+
+	Result Weak(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency)
+	{
+		const size_t numOfNodes = outAdjacency.offsets.size() - 1;
+		std::vector<unsigned int> parents(numOfNodes);
+		for (size_t n = 0; n < numOfNodes; ++n)
+		{
+			parents[n] = static_cast<unsigned int>(n);
+		}
+		if (numOfNodes == 0)
+		{
+			return {};
+		}
+
+		ThreadPool& pool = ThreadPool::getGlobal();
+		for (unsigned int round = 0; round < NEIGHBOR_ROUNDS; ++round)
+		{
+			pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+				{
+					for (size_t u = begin; u < end; ++u)
+					{
+						if (round < outAdjacency.degree(u))
+						{
+							Link(static_cast<unsigned int>(u), outAdjacency.neighbors[outAdjacency.offsets[u] + round], parents);
+						}
+					}
+				}, NODES_PER_CHUNK);
+			Compress(parents);
+		}
+
+		// Edges of the largest component so far would mostly link nodes that are connected already. Every edge with
+		// an end outside of it is still seen, from the out-edges or the in-edges of that end.
+		const unsigned int frequent = SampleFrequentRoot(parents);
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t u = begin; u < end; ++u)
+				{
+					if (Load(parents[u]) == frequent)
+					{
+						continue;
+					}
+					for (unsigned int k = outAdjacency.offsets[u] + NEIGHBOR_ROUNDS; k < outAdjacency.offsets[u + 1]; ++k)
+					{
+						Link(static_cast<unsigned int>(u), outAdjacency.neighbors[k], parents);
+					}
+					for (unsigned int k = inAdjacency.offsets[u]; k < inAdjacency.offsets[u + 1]; ++k)
+					{
+						Link(static_cast<unsigned int>(u), inAdjacency.neighbors[k], parents);
+					}
+				}
+			}, NODES_PER_CHUNK);
+		Compress(parents);
+
+		return Finalize(parents);
+	}
+
+	Result Weak(const Graph& graph)
+	{
+		return Weak(graph.getOutAdjacency(), graph.getInAdjacency());
+	}
+
+	Result Strong(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency)
+	{
+		const size_t numOfNodes = outAdjacency.offsets.size() - 1;
+		std::vector<unsigned int> representatives(numOfNodes, NONE);
+		ThreadPool& pool = ThreadPool::getGlobal();
+
+		// A node without in-edges or without out-edges is on no cycle.
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t n = begin; n < end; ++n)
+				{
+					if (outAdjacency.degree(n) == 0 || inAdjacency.degree(n) == 0)
+					{
+						representatives[n] = static_cast<unsigned int>(n);
+					}
+				}
+			}, NODES_PER_CHUNK);
+
+		unsigned int pivot = NONE;
+		unsigned long long pivotScore = 0;
+		for (unsigned int n = 0; n < numOfNodes; ++n)
+		{
+			const unsigned long long score = static_cast<unsigned long long>(outAdjacency.degree(n)) * inAdjacency.degree(n);
+			if (representatives[n] == NONE && score > pivotScore)
+			{
+				pivot = n;
+				pivotScore = score;
+			}
+		}
+
+		if (pivot != NONE)
+		{
+			const BFS::Result forward = BFS::Run(outAdjacency, inAdjacency, { pivot });
+			const BFS::Result backward = BFS::Run(inAdjacency, outAdjacency, { pivot });
+			auto inPivotComponent = [&](size_t n) { return forward.distances[n] != BFS::UNREACHED && backward.distances[n] != BFS::UNREACHED; };
+
+			unsigned int smallest = 0;
+			while (!inPivotComponent(smallest))
+			{
+				smallest++;
+			}
+			pool.parallelFor(smallest, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+				{
+					for (size_t n = begin; n < end; ++n)
+					{
+						if (inPivotComponent(n))
+						{
+							representatives[n] = smallest;
+						}
+					}
+				}, NODES_PER_CHUNK);
+		}
+
+		Tarjan(outAdjacency, representatives);
+		return Finalize(representatives);
+	}
+
+	Result Strong(const Graph& graph)
+	{
+		return Strong(graph.getOutAdjacency(), graph.getInAdjacency());
+	}
+
+	void ColorComponents(Graph& graph, const Result& result)
+	{
+		for (int n = 0; n < graph.getNumOfNodes(); ++n)
+		{
+			graph.setNodeColor(n, ComponentColor(result.labels[n]));
+		}
+		for (int e = 0; e < graph.getNumOfEdges(); ++e)
+		{
+			const Edge& edge = graph.getEdge(e);
+			const unsigned int label = result.labels[edge.start->index];
+			if (label == result.labels[edge.end->index])
+			{
+				graph.setEdgeColor(e, ComponentColor(label));
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Graph.h"
+#include "SparseMatrix.h"
+#include <utility>
+#include <vector>
+
+// Weakly and strongly connected components. Nothing recurses, so long paths cannot overflow the stack.
+// Components are numbered in the order of their smallest node, so labels do not depend on the number of threads.
+namespace Components
+{
+	struct Result
+	{
+		std::vector<unsigned int> labels;	// Component of every node, in [0, getNumOfComponents()).
+		std::vector<unsigned int> sizes;	// Nodes of every component.
+
+		unsigned int getNumOfComponents() const { return static_cast<unsigned int>(sizes.size()); }
+		// Label of the largest component (the smallest label among equally large ones), 0 for an empty graph.
+		unsigned int getLargest() const;
+		// (size, number of components of that size) pairs, by increasing size.
+		std::vector<std::pair<unsigned int, unsigned int>> getSizeHistogram() const;
+	};
+
+	// Components ignoring the edge directions. Afforest (Sutton, Ben-Nun and Barak): a few neighbors per node are
+	// linked in a parallel union-find, then the nodes of the by-now largest component, found by sampling, skip the
+	// rest of their edges. Roots always hook under smaller roots, lock-free with compare-and-swap.
+	Result Weak(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency);
+	Result Weak(const Graph& graph);
+
+	// Components along the edge directions. Nodes without in- or out-edges are trimmed in parallel, the component of
+	// a high degree pivot (usually the giant one) is the intersection of its forward and backward reach, found with
+	// two parallel BFS. An iterative Tarjan handles what is left.
+	Result Strong(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency);
+	Result Strong(const Graph& graph);
+
+	// Gives every component its own color, its nodes and the edges inside it.
+	void ColorComponents(Graph& graph, const Result& result);
+}
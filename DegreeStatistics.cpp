@@ -0,0 +1,149 @@
+#include "DegreeStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DegreeStatistics::build(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency)
+{
+	const size_t numOfNodes = outAdjacency.offsets.size() - 1;
+	m_inDegrees.resize(numOfNodes);
+	m_outDegrees.resize(numOfNodes);
+	m_in = {};
+	m_out = {};
+	m_total = {};
+	for (size_t i = 0; i < numOfNodes; ++i)
+	{
+		m_inDegrees[i] = inAdjacency.degree(i);
+		m_outDegrees[i] = outAdjacency.degree(i);
+		m_in.insert(m_inDegrees[i]);
+		m_out.insert(m_outDegrees[i]);
+		m_total.insert(m_inDegrees[i] + m_outDegrees[i]);
+	}
+}
+
+void DegreeStatistics::addNode()
+{
+	m_inDegrees.push_back(0);
+	m_outDegrees.push_back(0);
+	m_in.insert(0);
+	m_out.insert(0);
+	m_total.insert(0);
+}
+
+void DegreeStatistics::removeNode(size_t index)
+{
+	m_in.erase(m_inDegrees[index]);
+	m_out.erase(m_outDegrees[index]);
+	m_total.erase(m_inDegrees[index] + m_outDegrees[index]);
+	m_inDegrees[index] = m_inDegrees.back();
+	m_outDegrees[index] = m_outDegrees.back();
+	m_inDegrees.pop_back();
+	m_outDegrees.pop_back();
+}
+
+void DegreeStatistics::addEdge(size_t start, size_t end)
+{
+	const unsigned int startDegree = getDegree(start);
+	const unsigned int endDegree = getDegree(end);
+	m_out.move(m_outDegrees[start], m_outDegrees[start] + 1);
+	m_in.move(m_inDegrees[end], m_inDegrees[end] + 1);
+	m_total.move(startDegree, startDegree + 1);
+	m_total.move(endDegree, endDegree + 1);
+	m_outDegrees[start]++;
+	m_inDegrees[end]++;
+}
+
+void DegreeStatistics::removeEdge(size_t start, size_t end)
+{
+	const unsigned int startDegree = getDegree(start);
+	const unsigned int endDegree = getDegree(end);
+	m_out.move(m_outDegrees[start], m_outDegrees[start] - 1);
+	m_in.move(m_inDegrees[end], m_inDegrees[end] - 1);
+	m_total.move(startDegree, startDegree - 1);
+	m_total.move(endDegree, endDegree - 1);
+	m_outDegrees[start]--;
+	m_inDegrees[end]--;
+}
+
+float DegreeStatistics::getAverage(Kind kind) const
+{
+	const Distribution& d = distribution(kind);
+	return d.count > 0 ? static_cast<float>(double(d.sum) / double(d.count)) : 0.0f;
+}
+
+unsigned int DegreeStatistics::getCount(Kind kind, unsigned int degree) const
+{
+	const std::vector<unsigned int>& histogram = distribution(kind).histogram;
+	return degree < histogram.size() ? histogram[degree] : 0;
+}
+
+unsigned int DegreeStatistics::getPercentile(Kind kind, float fraction) const
+{
+	const Distribution& d = distribution(kind);
+	if (d.count == 0)
+	{
+		return 0;
+	}
+
+	// Rank of the node we are after, 1-based.
+	const double clamped = std::clamp(double(fraction), 0.0, 1.0);
+	const size_t rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(clamped * double(d.count))));
+	size_t seen = 0;
+	for (unsigned int degree = d.minimum; degree <= d.maximum; ++degree)
+	{
+		seen += d.histogram[degree];
+		if (seen >= rank)
+		{
+			return degree;
+		}
+	}
+	return d.maximum;
+}
+
+void DegreeStatistics::Distribution::insert(unsigned int degree)
+{
+	if (degree >= histogram.size())
+	{
+		histogram.resize(degree + 1, 0);
+	}
+	histogram[degree]++;
+	sum += degree;
+	count++;
+
+	if (count == 1)
+	{
+		minimum = degree;
+		maximum = degree;
+	}
+	minimum = std::min(minimum, degree);
+	maximum = std::max(maximum, degree);
+}
+
+void DegreeStatistics::Distribution::erase(unsigned int degree)
+{
+	histogram[degree]--;
+	sum -= degree;
+	count--;
+
+	if (count == 0)
+	{
+		minimum = 0;
+		maximum = 0;
+		return;
+	}
+	// Edge updates only ever walk one bucket, see move(). Removing a node can walk further, once.
+	if (histogram[degree] == 0 && degree == minimum)
+	{
+		while (histogram[minimum] == 0)
+		{
+			minimum++;
+		}
+	}
+	if (histogram[degree] == 0 && degree == maximum)
+	{
+		while (histogram[maximum] == 0)
+		{
+			maximum--;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "SparseMatrix.h"
+
+#include <cstddef>
+#include <vector>
+
+// In-, out- and total degree of every node, with a histogram of each. Built once in O(N) and then kept up to date
+// edge by edge: an edge moves one node by one bucket on each side, so minimum and maximum move by at most one
+// bucket too, and every update is O(1).
+class DegreeStatistics
+{
+public:
+	enum class Kind
+	{
+		In,
+		Out,
+		Total	// In + out.
+	};
+
+	void build(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency);
+
+	// A new node has no edges. A node is removed after its edges, the last node then takes its index.
+	void addNode();
+	void removeNode(size_t index);
+	void addEdge(size_t start, size_t end);
+	void removeEdge(size_t start, size_t end);
+
+	size_t getNumOfNodes() const { return m_inDegrees.size(); }
+	unsigned int getInDegree(size_t node) const { return m_inDegrees[node]; }
+	unsigned int getOutDegree(size_t node) const { return m_outDegrees[node]; }
+	unsigned int getDegree(size_t node) const { return m_inDegrees[node] + m_outDegrees[node]; }
+
+	// 0 for a graph without nodes.
+	unsigned int getMinimum(Kind kind) const { return distribution(kind).minimum; }
+	unsigned int getMaximum(Kind kind) const { return distribution(kind).maximum; }
+	float getAverage(Kind kind) const;
+	// histogram[d] is the number of nodes of degree d. It may have trailing zeros past the maximum.
+	const std::vector<unsigned int>& getHistogram(Kind kind) const { return distribution(kind).histogram; }
+	// Number of nodes of the given degree.
+	unsigned int getCount(Kind kind, unsigned int degree) const;
+	// Smallest degree d such that at least fraction (0 to 1) of the nodes have degree <= d, e.g. 0.5 for the median.
+	// Walks the histogram, O(maximum degree).
+	unsigned int getPercentile(Kind kind, float fraction) const;
+
+private:
+	struct Distribution
+	{
+		std::vector<unsigned int> histogram;
+		unsigned int minimum = 0;
+		unsigned int maximum = 0;
+		unsigned long long sum = 0;
+		size_t count = 0;
+
+		void insert(unsigned int degree);
+		void erase(unsigned int degree);
+		// Insert first, so that erase finds the new value when it looks for the next minimum or maximum.
+		void move(unsigned int from, unsigned int to)
+		{
+			insert(to);
+			erase(from);
+		}
+	};
+
+	const Distribution& distribution(Kind kind) const
+	{
+		return kind == Kind::In ? m_in : kind == Kind::Out ? m_out : m_total;
+	}
+
+	std::vector<unsigned int> m_inDegrees;
+	std::vector<unsigned int> m_outDegrees;
+	Distribution m_in;
+	Distribution m_out;
+	Distribution m_total;
+};
@@ -1,7 +1,8 @@
 #include "Graph.h"
 
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <iterator>
 
 // NOTE: Throughout the code "vertex" means rendering vertices and "nodes" mean the graph nodes.
 
@@ -10,32 +11,44 @@
 
 // Constructor with an adjacency matrix input.
 Graph::Graph(const std::vector<std::vector<int>>& adjacencyMatrix)
-	: m_areaSize{static_cast<float>(adjacencyMatrix.size())},
-	  m_nodes{adjacencyMatrix.size()},
-	  m_adjacencyMatrix{adjacencyMatrix},
-	  m_nodeVertices{sf::PrimitiveType::Triangles, adjacencyMatrix.size() * 6}
-{ 
-	adjacencyMatrixToGeometry();
+	: Graph{ SparseMatrix::fromDense(adjacencyMatrix) }
+{
 }
 
-// Constructor with a path to an adjacency matrix.
-Graph::Graph(const std::string& path)
+// Constructor with a sparse (CSR) adjacency matrix.
+Graph::Graph(const SparseMatrix& adjacency)
+	: Graph{ adjacency.view(), nullptr }
 {
-	readAdjacencyMatrixFromFile(path);
-	m_areaSize = static_cast<float>(m_adjacencyMatrix.size());
-	m_nodes.resize(m_adjacencyMatrix.size());
-	m_nodeVertices = sf::VertexArray(sf::PrimitiveType::Triangles, m_adjacencyMatrix.size() * 6);
+}
 
-	adjacencyMatrixToGeometry();
+// Constructor with a path to a graph file, see GraphFile.h for the formats.
+Graph::Graph(const std::string& path, GraphFile::Format format)
+	: Graph{ GraphFile::Load(path, format) }
+{
 }
 
+// Binary files are read in place from the mapping, which is released once the graph is built.
+Graph::Graph(const GraphFile::Contents& file)
+	: Graph{ file.getAdjacency(), file.getPositions() }
+{
+}
 
-void Graph::adjacencyMatrixToGeometry()
+// This is the main path, the other constructors end up here.
+Graph::Graph(const SparseMatrixView& adjacency, const float* positions)
+	: m_nodes{ adjacency.numOfRows },
+	  m_areaSize{ static_cast<float>(adjacency.numOfRows) },
+	  m_nodeVertices{ sf::PrimitiveType::Triangles, adjacency.numOfRows * 6 }
+{
+	adjacencyMatrixToGeometry(adjacency, positions);
+}
+
+
+void Graph::adjacencyMatrixToGeometry(const SparseMatrixView& adjacency, const float* positions)
 {
 	// For now seed for reproducibility.
 	std::srand(0);
 	// Number of vertices
-	const unsigned int numOfNodes = static_cast<int>(m_adjacencyMatrix.size());
+	const unsigned int numOfNodes = adjacency.numOfRows;
 
 	if (numOfNodes == 0)
 	{
@@ -43,76 +56,100 @@ void Graph::adjacencyMatrixToGeometry()
 		return;
 	}
 
-	// Process edges. First pass to determine the number of edges.
+	// Process edges. First pass to determine the number of edges, self-loops are not drawn so they are skipped.
 	unsigned int numOfEdges = 0;
-	for (int i = 0; i < numOfNodes; ++i)
+	std::vector<unsigned int> inCounts(numOfNodes + 1, 0);
+	for (unsigned int i = 0; i < numOfNodes; ++i)
 	{
 		m_nodes[i].index = i;
-		for (int j = i + 1; j < numOfNodes; ++j)
+		for (unsigned int k = adjacency.offsets[i]; k < adjacency.offsets[i + 1]; ++k)
 		{
-			if (m_adjacencyMatrix[i][j] != 0)
-			{
-				numOfEdges++;
-			}
-			if (m_adjacencyMatrix[j][i] != 0)
+			if (adjacency.columns[k] != i)
 			{
 				numOfEdges++;
+				inCounts[adjacency.columns[k] + 1]++;
 			}
 		}
 	}
 	m_edges.resize(numOfEdges);
 	m_edgeVertices = sf::VertexArray(sf::PrimitiveType::Triangles, numOfEdges * 9);
+	m_nodeBounds.resize(numOfNodes);
+	m_edgeBounds.resize(numOfEdges);
+	m_nodeProperties.resize(numOfNodes);
+	m_edgeProperties.resize(numOfEdges);
+
+	// Out-edges (CSR) are laid out in edge order, in-edges (CSC) are bucketed by their end node.
+	m_outAdjacency.offsets.assign(numOfNodes + 1, 0);
+	m_outAdjacency.neighbors.resize(numOfEdges);
+	m_outAdjacency.edges.resize(numOfEdges);
+	for (unsigned int i = 0; i < numOfNodes; ++i)
+	{
+		inCounts[i + 1] += inCounts[i];
+	}
+	m_inAdjacency.offsets = inCounts;
+	m_inAdjacency.neighbors.resize(numOfEdges);
+	m_inAdjacency.edges.resize(numOfEdges);
+	std::vector<unsigned int> inCursor(inCounts.begin(), inCounts.end() - 1);
+
+	for (unsigned int i = 0; i < numOfNodes; ++i)
+	{
+		m_nodes[i].outEdges.reserve(adjacency.offsets[i + 1] - adjacency.offsets[i]);
+		m_nodes[i].inEdges.reserve(inCounts[i + 1] - inCounts[i]);
+	}
 
 	// Second pass to set the edges.
 	unsigned int currentEdge = 0;
-	for (int i = 0; i < numOfNodes; ++i)
+	for (unsigned int i = 0; i < numOfNodes; ++i)
 	{
-		for (int j = i + 1; j < numOfNodes; ++j)
+		for (unsigned int k = adjacency.offsets[i]; k < adjacency.offsets[i + 1]; ++k)
 		{
-			if (m_adjacencyMatrix[i][j] != 0)
+			const unsigned int j = adjacency.columns[k];
+			if (j == i)
 			{
-				Edge& edge = m_edges[currentEdge];
+				continue;
+			}
 
-				edge.start = &m_nodes[i];
-				edge.end = &m_nodes[j];
-				edge.index = currentEdge;
-				edge.weight = m_adjacencyMatrix[i][j];
+			Edge& edge = m_edges[currentEdge];
 
-				m_nodes[i].outEdges.push_back(&edge);
-				m_nodes[j].inEdges.push_back(&edge);
+			edge.start = &m_nodes[i];
+			edge.end = &m_nodes[j];
+			edge.index = currentEdge;
+			edge.weight = adjacency.value(k);
 
-				setEdgeColor(currentEdge, Settings::EDGE_COLOR, Settings::EDGE_ALPHA);
+			m_nodes[i].outEdges.push_back(&edge);
+			m_nodes[j].inEdges.push_back(&edge);
 
-				currentEdge++;
-			}
-			if (m_adjacencyMatrix[j][i] != 0)
-			{
-				Edge& edge = m_edges[currentEdge];
+			m_outAdjacency.neighbors[currentEdge] = j;
+			m_outAdjacency.edges[currentEdge] = currentEdge;
+			m_inAdjacency.neighbors[inCursor[j]] = i;
+			m_inAdjacency.edges[inCursor[j]] = currentEdge;
+			inCursor[j]++;
 
-				edge.start = &m_nodes[j];
-				edge.end = &m_nodes[i];
-				edge.index = currentEdge;
-				edge.weight = m_adjacencyMatrix[j][i];
+			setEdgeColor(currentEdge, Settings::EDGE_COLOR, Settings::EDGE_ALPHA);
 
-				m_nodes[i].inEdges.push_back(&edge);
-				m_nodes[j].outEdges.push_back(&edge);
+			currentEdge++;
+		}
+		m_outAdjacency.offsets[i + 1] = currentEdge;
+	}
 
-				setEdgeColor(currentEdge, Settings::EDGE_COLOR, Settings::EDGE_ALPHA);
+	buildReverseEdges();
 
-				currentEdge++;
-			}
-		}
+	const double possibleEdges = double(numOfNodes) * double(numOfNodes - 1);
+	if (numOfNodes <= Settings::DENSE_ADJACENCY_MAX_NODES && numOfEdges >= Settings::DENSE_ADJACENCY_DENSITY * possibleEdges)
+	{
+		setDenseAdjacency(true);
 	}
 
 	// Initialize the colors
-	// First assign random positions to all vertices
+	// First assign random positions to all vertices, unless a layout was given.
 	for (size_t i = 0; i < numOfNodes; ++i)
 	{
 		setNodeColor(i, Settings::NODE_COLOR);
 
-		float x = randFloat() * m_areaSize - (m_areaSize / 2.0f);
-		float y = randFloat() * m_areaSize - (m_areaSize / 2.0f);
+		float x = positions ? positions[2 * i] : randFloat() * m_areaSize - (m_areaSize / 2.0f);
+		float y = positions ? positions[2 * i + 1] : randFloat() * m_areaSize - (m_areaSize / 2.0f);
 		m_nodes[i].position = sf::Vector2f{ x, y };
+		m_spatialIndex.insert(m_nodes[i].position);
 		setVertexPositionsOfNode(i);
 	}
 
@@ -122,154 +159,416 @@ void Graph::adjacencyMatrixToGeometry()
 		setVertexPositionsOfEdge(i);
 	}
 
-	// Iterative position determination.
-	for (int iter = 0; iter < m_iterations; ++iter)
+	// Iterative position determination. A stored layout has already been through it.
+	for (int iter = 0; !positions && iter < m_iterations; ++iter)
 	{
 		updateGeometry();
 	}
 
-	calculateImportantParameters();
+	m_degrees.build(m_outAdjacency, m_inAdjacency);
+	m_topologyStale = false;
 }
 
 void Graph::updateGeometry(int nodeHeld, sf::Vector2f inject)
 {
-	unsigned int numOfNodes = m_adjacencyMatrix.size();
+	refreshTopology();
+	m_layout.step(m_nodes, m_outAdjacency, m_inAdjacency, nodeHeld, inject);
+	updateSpatialIndex();
 
-	// Temporary array for force sums.
-	std::vector<sf::Vector2f> forces{ numOfNodes, sf::Vector2f{0.0f, 0.0f} };
-
-	// Compute forces to make nodes appear separate in space.
-	for (int i = 0; i < numOfNodes; ++i)
-	{
-		for (int j = i + 1; j < numOfNodes; ++j)
+	// Update vertex positions of nodes for rendering.
+	m_layout.getThreadPool().parallelFor(0, m_nodes.size(), [this](size_t begin, size_t end, unsigned int)
 		{
-			sf::Vector2f dr = m_nodes[j].position - m_nodes[i].position;
-			float dist = dr.length();
-
-			// Avoid infinite forces
-			if (dist < 1e-2f)
+			for (size_t i = begin; i < end; ++i)
 			{
-				dist = 1e-2f;
+				setVertexPositionsOfNode(i);
 			}
+		}, 4096);
 
-			// Calculate ~1/r force. F = -(k/r) * r_hat.
-			// r_hat points from i to j.
-			sf::Vector2f r_hat = dr / dist;
-			sf::Vector2f repulsiveForce = (m_repulsion / dist) * r_hat;
-
-			// Third law, equal and opposite.
-			if (nodeHeld != i)
+	// Update vertex positions of edges for rendering. Every edge only writes its own vertices.
+	m_layout.getThreadPool().parallelFor(0, m_edges.size(), [this](size_t begin, size_t end, unsigned int)
+		{
+			for (size_t i = begin; i < end; ++i)
 			{
-				forces[i] -= repulsiveForce;
+				setVertexPositionsOfEdge(i);
 			}
-			forces[j] += repulsiveForce;
+		}, 4096);
+}
 
-			// Spring (attractive) forces.
-			if (m_adjacencyMatrix[i][j] != 0 || m_adjacencyMatrix[j][i] != 0)
-			{
-				// Hook's force ~r. F = k * r * r_hat.
-				sf::Vector2f attractiveForce = m_attraction * dist * r_hat;
-				if (nodeHeld != i)
-				{
-					forces[i] += attractiveForce;
-				}
-				forces[j] -= attractiveForce;
-			}
+// For every edge i -> j, the index of the edge j -> i or -1. Computed once, O(M log(degree)).
+void Graph::buildReverseEdges()
+{
+	m_reverseEdges.assign(m_edges.size(), -1);
+	for (size_t k = 0; k < m_edges.size(); ++k)
+	{
+		const unsigned int start = m_edges[k].start->index;
+		const unsigned int end = m_edges[k].end->index;
+
+		auto rowBegin = m_outAdjacency.neighbors.begin() + m_outAdjacency.offsets[end];
+		auto rowEnd = m_outAdjacency.neighbors.begin() + m_outAdjacency.offsets[end + 1];
+		auto it = std::lower_bound(rowBegin, rowEnd, start);
+		if (it != rowEnd && *it == start)
+		{
+			m_reverseEdges[k] = static_cast<int>(m_outAdjacency.edges[it - m_outAdjacency.neighbors.begin()]);
 		}
 	}
+}
 
-	// Update vertex positions of nodes for rendering.
-	for (int i = 0; i < numOfNodes; ++i)
+namespace
+{
+	// Swap and pop. Searches from the back, so emptying a list from the back is O(1) per edge.
+	void EraseEdge(std::vector<Edge*>& edges, const Edge* edge)
 	{
-		m_nodes[i].position += forces[i];
-		if (nodeHeld == i)
+		for (size_t k = edges.size(); k-- > 0;)
 		{
-			m_nodes[i].position = inject;
+			if (edges[k] == edge)
+			{
+				edges[k] = edges.back();
+				edges.pop_back();
+				return;
+			}
 		}
-		setVertexPositionsOfNode(i);
 	}
 
-	// Update vertex positions of edges for rendering.
-	for (int i = 0; i < m_edges.size(); ++i)
+	void ReplaceEdge(std::vector<Edge*>& edges, Edge* oldEdge, Edge* newEdge)
 	{
-		setVertexPositionsOfEdge(i);
+		std::replace(edges.begin(), edges.end(), oldEdge, newEdge);
 	}
 }
 
-void Graph::setVertexPositionsOfNode(size_t i)
+unsigned int Graph::addNode()
 {
-	sf::Vector2f position = m_nodes[i].position;
-	m_nodeVertices[6 * i].position = { position.x, position.y };
-	m_nodeVertices[6 * i + 1].position = { position.x + m_nodeSize, position.y };
-	m_nodeVertices[6 * i + 2].position = { position.x, position.y + m_nodeSize };
-	m_nodeVertices[6 * i + 3].position = { position.x + m_nodeSize, position.y + m_nodeSize };
-	m_nodeVertices[6 * i + 4].position = { position.x + m_nodeSize, position.y };
-	m_nodeVertices[6 * i + 5].position = { position.x, position.y + m_nodeSize };
+	return addNode({ randFloat() * m_areaSize - (m_areaSize / 2.0f), randFloat() * m_areaSize - (m_areaSize / 2.0f) });
+}
+
+unsigned int Graph::addNode(sf::Vector2f position)
+{
+	reserveNodes(m_nodes.size() + 1);
+	const unsigned int index = static_cast<unsigned int>(m_nodes.size());
+	Node& node = m_nodes.emplace_back();
+	node.index = index;
+	node.position = position;
+
+	m_nodeVertices.resize(6 * (index + 1));
+	m_nodeBounds.emplace_back();
+	setNodeColor(index, Settings::NODE_COLOR);
+	setVertexPositionsOfNode(index);
+	m_spatialIndex.insert(position);
+	m_nodeProperties.pushBack();
+	m_degrees.addNode();
+	if (m_denseAdjacency)
+	{
+		m_adjacencyBits.addNode();
+	}
+
+	topologyChanged();
+	return index;
 }
 
-void Graph::readAdjacencyMatrixFromFile(const std::string& path)
+void Graph::removeNode(size_t index)
 {
-	std::ifstream file(path);
-	if (!file.is_open())
+	if (index >= m_nodes.size())
 	{
-		std::cerr << "ERROR::COULD NOT OPEN FILE: " << path << std::endl;
+		std::cerr << "ERROR::NODE " << index << " DOES NOT EXIST" << std::endl;
 		return;
 	}
 
-	// Read the first line to deduce the size
-	std::string line;
-	if (!std::getline(file, line))
+	// Each removal takes the last edge of the list, which EraseEdge finds first.
+	while (!m_nodes[index].outEdges.empty())
+	{
+		removeEdge(m_nodes[index].outEdges.back()->index);
+	}
+	while (!m_nodes[index].inEdges.empty())
+	{
+		removeEdge(m_nodes[index].inEdges.back()->index);
+	}
+
+	// Move the last node into the freed slot. Its edges keep their geometry, only their pointers change.
+	const size_t last = m_nodes.size() - 1;
+	if (index != last)
+	{
+		Node& node = m_nodes[index];
+		node = std::move(m_nodes[last]);
+		node.index = static_cast<unsigned int>(index);
+		for (Edge* edge : node.outEdges)
+		{
+			edge->start = &node;
+		}
+		for (Edge* edge : node.inEdges)
+		{
+			edge->end = &node;
+		}
+
+		for (size_t i = 0; i < 6; ++i)
+		{
+			m_nodeVertices[6 * index + i] = m_nodeVertices[6 * last + i];
+		}
+		m_nodeBounds[index] = m_nodeBounds[last];
+	}
+	m_nodes.pop_back();
+	m_nodeVertices.resize(6 * last);
+	m_nodeBounds.pop_back();
+	m_spatialIndex.swapRemove(static_cast<unsigned int>(index));
+	m_nodeProperties.swapRemove(index);
+	m_degrees.removeNode(index);
+	if (m_denseAdjacency)
+	{
+		m_adjacencyBits.swapRemove(index);
+	}
+
+	m_numOfNodeRemovals++;
+	topologyChanged();
+}
+
+int Graph::addEdge(size_t start, size_t end, int weight)
+{
+	if (start >= m_nodes.size() || end >= m_nodes.size())
+	{
+		std::cerr << "ERROR::CANNOT ADD EDGE " << start << " -> " << end << ", NODE DOES NOT EXIST" << std::endl;
+		return -1;
+	}
+	if (start == end)
+	{
+		std::cerr << "WARNING::SELF-LOOPS ARE NOT SUPPORTED, EDGE " << start << " -> " << end << " IGNORED" << std::endl;
+		return -1;
+	}
+
+	const int existing = findEdge(start, end);
+	if (existing >= 0)
+	{
+		m_edges[existing].weight = weight;
+		return existing;
+	}
+
+	reserveEdges(m_edges.size() + 1);
+	const unsigned int index = static_cast<unsigned int>(m_edges.size());
+	Edge& edge = m_edges.emplace_back();
+	edge.start = &m_nodes[start];
+	edge.end = &m_nodes[end];
+	edge.index = index;
+	edge.weight = weight;
+	m_nodes[start].outEdges.push_back(&edge);
+	m_nodes[end].inEdges.push_back(&edge);
+	m_degrees.addEdge(start, end);
+	if (m_denseAdjacency)
 	{
-		std::cerr << "ERROR::FILE " << path << " APPEARS TO BE EMPTY." << std::endl;
+		m_adjacencyBits.set(start, end);
+	}
+
+	const int reverse = findEdge(end, start);
+	m_reverseEdges.push_back(reverse);
+	m_edgeVertices.resize(9 * (index + 1));
+	m_edgeBounds.emplace_back();
+	m_edgeProperties.pushBack();
+	setEdgeColor(index, Settings::EDGE_COLOR, Settings::EDGE_ALPHA);
+	setVertexPositionsOfEdge(index);
+	if (reverse >= 0)
+	{
+		// The pair is now drawn side by side.
+		m_reverseEdges[reverse] = static_cast<int>(index);
+		setVertexPositionsOfEdge(reverse);
+	}
+
+	topologyChanged();
+	return static_cast<int>(index);
+}
+
+void Graph::removeEdge(size_t index)
+{
+	if (index >= m_edges.size())
+	{
+		std::cerr << "ERROR::EDGE " << index << " DOES NOT EXIST" << std::endl;
 		return;
 	}
 
-	std::istringstream iss(line);
-	std::vector<int> firstRow;
-	int temp;
-	while (iss >> temp)
+	Edge& edge = m_edges[index];
+	EraseEdge(edge.start->outEdges, &edge);
+	EraseEdge(edge.end->inEdges, &edge);
+	m_degrees.removeEdge(edge.start->index, edge.end->index);
+	if (m_denseAdjacency)
+	{
+		m_adjacencyBits.reset(edge.start->index, edge.end->index);
+	}
+	int reverse = m_reverseEdges[index];
+	if (reverse >= 0)
+	{
+		m_reverseEdges[reverse] = -1;
+	}
+
+	const size_t last = m_edges.size() - 1;
+	if (index != last)
+	{
+		moveLastEdge(index);
+		if (static_cast<size_t>(reverse) == last)
+		{
+			reverse = static_cast<int>(index);
+		}
+	}
+	m_edges.pop_back();
+	m_reverseEdges.pop_back();
+	m_edgeVertices.resize(9 * last);
+	m_edgeBounds.pop_back();
+	m_edgeProperties.swapRemove(index);
+
+	// Which edge of a pair lies above depends on the indices, so redraw the pairs that changed.
+	if (reverse >= 0)
 	{
-		firstRow.push_back(temp);
+		setVertexPositionsOfEdge(reverse);
+	}
+	if (index != last)
+	{
+		setVertexPositionsOfEdge(index);
+		if (m_reverseEdges[index] >= 0)
+		{
+			setVertexPositionsOfEdge(m_reverseEdges[index]);
+		}
 	}
 
-	const size_t N = firstRow.size();
-	if (N == 0)
+	topologyChanged();
+}
+
+void Graph::moveLastEdge(size_t index)
+{
+	const size_t last = m_edges.size() - 1;
+	Edge& edge = m_edges[index];
+	edge = m_edges[last];
+	edge.index = static_cast<unsigned int>(index);
+	ReplaceEdge(edge.start->outEdges, &m_edges[last], &edge);
+	ReplaceEdge(edge.end->inEdges, &m_edges[last], &edge);
+
+	m_reverseEdges[index] = m_reverseEdges[last];
+	if (m_reverseEdges[index] >= 0)
+	{
+		m_reverseEdges[m_reverseEdges[index]] = static_cast<int>(index);
+	}
+
+	for (size_t i = 0; i < 9; ++i)
+	{
+		m_edgeVertices[9 * index + i] = m_edgeVertices[9 * last + i];
+	}
+	m_edgeBounds[index] = m_edgeBounds[last];
+}
+
+void Graph::reserveNodes(size_t count)
+{
+	if (count <= m_nodes.capacity())
 	{
-		std::cerr << "ERROR:: FIRST ROW EMPTY, CANNOT DEDUCE MATRIX SIZE " << std::endl;
 		return;
 	}
 
-	m_adjacencyMatrix.clear();
-	m_adjacencyMatrix.resize(N, std::vector<int>(N, 0));
+	// The old nodes stay alive until the edges point to the new ones. Doubling keeps additions amortized O(1).
+	std::vector<Node> nodes;
+	nodes.reserve(std::max(count, 2 * m_nodes.capacity()));
+	std::move(m_nodes.begin(), m_nodes.end(), std::back_inserter(nodes));
+	for (Edge& edge : m_edges)
+	{
+		edge.start = &nodes[edge.start->index];
+		edge.end = &nodes[edge.end->index];
+	}
+	m_nodes.swap(nodes);
+}
 
-	for (size_t j = 0; j < N; ++j)
+void Graph::reserveEdges(size_t count)
+{
+	if (count <= m_edges.capacity())
 	{
-		m_adjacencyMatrix[0][j] = firstRow[j];
+		return;
 	}
 
-	for (size_t i = 1; i < N; ++i)
+	std::vector<Edge> edges;
+	edges.reserve(std::max(count, 2 * m_edges.capacity()));
+	std::move(m_edges.begin(), m_edges.end(), std::back_inserter(edges));
+	for (Node& node : m_nodes)
 	{
-		if (!std::getline(file, line))
+		for (Edge*& edge : node.outEdges)
 		{
-			std::cerr << "ERROR::FILE DOES NOT CONTAIN ENOUGH LINES TO FORM THE MATRIX" << std::endl;
-			return;
+			edge = &edges[edge->index];
 		}
+		for (Edge*& edge : node.inEdges)
+		{
+			edge = &edges[edge->index];
+		}
+	}
+	m_edges.swap(edges);
+}
+
+void Graph::topologyChanged()
+{
+	m_topologyStale = true;
+	m_topologyVersion++;
+	m_layout.setTopologyChanged();
+}
+
+void Graph::refreshTopology() const
+{
+	if (!m_topologyStale)
+	{
+		return;
+	}
+	rebuildAdjacency();
+	m_topologyStale = false;
+}
+
+// From the node lists, rows sorted by neighbor like the ones built from the adjacency matrix. O(N + M log(degree)).
+void Graph::rebuildAdjacency() const
+{
+	const size_t numOfNodes = m_nodes.size();
+	m_outAdjacency.offsets.assign(numOfNodes + 1, 0);
+	m_inAdjacency.offsets.assign(numOfNodes + 1, 0);
+	for (size_t i = 0; i < numOfNodes; ++i)
+	{
+		m_outAdjacency.offsets[i + 1] = m_outAdjacency.offsets[i] + static_cast<unsigned int>(m_nodes[i].outEdges.size());
+		m_inAdjacency.offsets[i + 1] = m_inAdjacency.offsets[i] + static_cast<unsigned int>(m_nodes[i].inEdges.size());
+	}
+	m_outAdjacency.neighbors.resize(m_edges.size());
+	m_outAdjacency.edges.resize(m_edges.size());
+	m_inAdjacency.neighbors.resize(m_edges.size());
+	m_inAdjacency.edges.resize(m_edges.size());
 
-		std::istringstream issRow(line);
-		for (size_t j = 0; j < N; ++j)
+	ThreadPool::getGlobal().parallelFor(0, numOfNodes, [this](size_t begin, size_t end, unsigned int)
 		{
-			if (!(issRow >> m_adjacencyMatrix[i][j]))
+			std::vector<std::pair<unsigned int, unsigned int>> row;	// Neighbor and edge.
+			auto fillRow = [&row](CompressedAdjacency& adjacency, size_t i)
+				{
+					std::sort(row.begin(), row.end());
+					for (size_t k = 0; k < row.size(); ++k)
+					{
+						adjacency.neighbors[adjacency.offsets[i] + k] = row[k].first;
+						adjacency.edges[adjacency.offsets[i] + k] = row[k].second;
+					}
+				};
+
+			for (size_t i = begin; i < end; ++i)
 			{
-				std::cerr << "ERROR::LINE " << i << " DOES NOT CONTAIN ENOUGH INTEGERS" << std::endl;
-				return;
+				row.clear();
+				for (const Edge* edge : m_nodes[i].outEdges)
+				{
+					row.emplace_back(edge->end->index, edge->index);
+				}
+				fillRow(m_outAdjacency, i);
+
+				row.clear();
+				for (const Edge* edge : m_nodes[i].inEdges)
+				{
+					row.emplace_back(edge->start->index, edge->index);
+				}
+				fillRow(m_inAdjacency, i);
 			}
-		}
-	}
+		}, 1024);
+}
 
-	file.close();
+void Graph::setVertexPositionsOfNode(size_t i)
+{
+	sf::Vector2f position = m_nodes[i].position;
+	m_nodeVertices[6 * i].position = { position.x, position.y };
+	m_nodeVertices[6 * i + 1].position = { position.x + m_nodeSize, position.y };
+	m_nodeVertices[6 * i + 2].position = { position.x, position.y + m_nodeSize };
+	m_nodeVertices[6 * i + 3].position = { position.x + m_nodeSize, position.y + m_nodeSize };
+	m_nodeVertices[6 * i + 4].position = { position.x + m_nodeSize, position.y };
+	m_nodeVertices[6 * i + 5].position = { position.x, position.y + m_nodeSize };
+	m_nodeBounds[i] = { position.x, position.y, position.x + m_nodeSize, position.y + m_nodeSize };
 }
 
-void Graph::setVertexPositionsOfEdge(size_t i, bool second)
+void Graph::setVertexPositionsOfEdge(size_t i)
 {
 	Node* start = m_edges[i].start;
 	Node* end = m_edges[i].end;
@@ -291,7 +590,9 @@ void Graph::setVertexPositionsOfEdge(size_t i, bool second)
 	sf::Vector2 centerOffset = { 0.5f * m_nodeSize, 0.5f * m_nodeSize };
 
 	// For directed networks, we can have two edges between two nodes, so adjust offset.
-	// Second edge lies below, first edge lies above.
+	// Second edge lies below, first edge lies above. Of a pair, the edge with the smaller index is the second one.
+	const int reverse = m_reverseEdges[i];
+	const bool second = reverse >= 0 && static_cast<size_t>(reverse) > i;
 	if (second)
 	{
 		centerOffset += {0.0f, 0.5f * centerOffset.y};
@@ -337,32 +638,67 @@ void Graph::setVertexPositionsOfEdge(size_t i, bool second)
 	m_edgeVertices[9 * i + 5].position = cornerB;
 
 	// Arrow
-	m_edgeVertices[9 * i + 6].position = pos1 + 0.5f* dr + Settings::EDGE_ARROW_SIZE * dr_hat;
+	sf::Vector2f arrowTip = pos1 + 0.5f * dr + Settings::EDGE_ARROW_SIZE * dr_hat;
+	m_edgeVertices[9 * i + 6].position = arrowTip;
 	m_edgeVertices[9 * i + 7].position = cornerA + 0.5f * dr;
 	m_edgeVertices[9 * i + 8].position = cornerB + 0.5f * dr;
 	m_edgeVertices[9 * i + 6].color = Settings::EDGE_ARROW_COLOR;
 	m_edgeVertices[9 * i + 7].color = Settings::EDGE_ARROW_COLOR;
 	m_edgeVertices[9 * i + 8].color = Settings::EDGE_ARROW_COLOR;
 
-	// If this is not the second edge between these vertices, look for a second edge.
-	if (!second)
-	{
-		for (size_t i = 0; i < end->outEdges.size(); ++i)
-		{
-			if (end->outEdges[i]->end == start)
-			{
-				setVertexPositionsOfEdge(end->outEdges[i]->index, true);
-			}
-		}
-	}
+	// Box around the quad and the arrow tip, for culling.
+	m_edgeBounds[i] = {
+		std::min({ cornerA.x, cornerB.x, cornerC.x, cornerD.x, arrowTip.x }),
+		std::min({ cornerA.y, cornerB.y, cornerC.y, cornerD.y, arrowTip.y }),
+		std::max({ cornerA.x, cornerB.x, cornerC.x, cornerD.x, arrowTip.x }),
+		std::max({ cornerA.y, cornerB.y, cornerC.y, cornerD.y, arrowTip.y }) };
 }
 
 void Graph::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
 	states.transform *= getTransform();
-	states.texture = nullptr;
-	target.draw(m_edgeVertices, states);
-	target.draw(m_nodeVertices, states);
+	m_culler.draw(target, states, m_nodeVertices, m_nodeBounds, m_edgeVertices, m_edgeBounds);
+}
+
+void Graph::save(const std::string& path) const
+{
+	refreshTopology();
+	std::vector<int> weights(m_edges.size());
+	for (size_t k = 0; k < m_edges.size(); ++k)
+	{
+		weights[k] = m_edges[m_outAdjacency.edges[k]].weight;
+	}
+
+	std::vector<float> positions(2 * m_nodes.size());
+	for (size_t i = 0; i < m_nodes.size(); ++i)
+	{
+		positions[2 * i] = m_nodes[i].position.x;
+		positions[2 * i + 1] = m_nodes[i].position.y;
+	}
+
+	SparseMatrixView adjacency{ static_cast<unsigned int>(m_nodes.size()), m_outAdjacency.offsets.data(), m_outAdjacency.neighbors.data(), weights.data() };
+	GraphFile::Write(path, adjacency, positions.data());
+}
+
+void Graph::takeSnapshot(GraphSnapshot& snapshot) const
+{
+	snapshot.transform = getTransform();
+	snapshot.nodeVertices = m_nodeVertices;
+	snapshot.edgeVertices = m_edgeVertices;
+	snapshot.nodeBounds = m_nodeBounds;
+	snapshot.edgeBounds = m_edgeBounds;
+	getEdgeLabels(snapshot.edgeLabelPositions, snapshot.edgeWeights);
+}
+
+void Graph::getEdgeLabels(std::vector<sf::Vector2f>& positions, std::vector<int>& weights) const
+{
+	positions.resize(m_edges.size());
+	weights.resize(m_edges.size());
+	for (size_t i = 0; i < m_edges.size(); ++i)
+	{
+		positions[i] = m_edges[i].position + Settings::WEIGHT_TEXT_DISTANCE * m_edges[i].normal;
+		weights[i] = m_edges[i].weight;
+	}
 }
 
 // Helpers
@@ -374,25 +710,26 @@ int Graph::findClosestNode(sf::Vector2f position, float tolerance) const
 		return -1;
 	}
 
-	size_t closestIndex = 0;
-	float minDistanceSquared = std::numeric_limits<float>::max();
+	return m_spatialIndex.nearest(position, tolerance);
+}
+
+void Graph::findNodesInRadius(sf::Vector2f center, float radius, std::vector<unsigned int>& result) const
+{
+	m_spatialIndex.queryRadius(center, radius, result);
+}
+
+void Graph::findNodesInRect(const sf::FloatRect& rect, std::vector<unsigned int>& result) const
+{
+	m_spatialIndex.queryRect(rect, result);
+}
 
+// O(N), but a node only touches the grid when it crosses into another cell.
+void Graph::updateSpatialIndex()
+{
 	for (size_t i = 0; i < m_nodes.size(); ++i)
 	{
-		sf::Vector2f diff = m_nodes[i].position - position;
-		float distSquared = diff.lengthSquared();
-
-		if (distSquared < minDistanceSquared)
-		{
-			minDistanceSquared = distSquared;
-			closestIndex = i;
-		}
+		m_spatialIndex.move(static_cast<unsigned int>(i), m_nodes[i].position);
 	}
-
-	if (minDistanceSquared > tolerance)
-		closestIndex = -1;
-
-	return closestIndex;
 }
 
 void Graph::setNodeColor(size_t index, sf::Color color, float alpha)
@@ -415,50 +752,78 @@ void Graph::setEdgeColor(size_t index, sf::Color color, float alpha)
 	}
 }
 
-void Graph::calculateImportantParameters()
+std::vector<std::vector<int>> Graph::getAdjacencyMatrix() const
 {
-	unsigned int minimumDegree = m_adjacencyMatrix.size();
-	unsigned int minimumInDegree = m_adjacencyMatrix.size();
-	unsigned int minimumOutDegree = m_adjacencyMatrix.size();
-	unsigned int maximumDegree = 0;
-	unsigned int maximumInDegree = 0;
-	unsigned int maximumOutDegree = 0;
-	float averageInDegree = 0;
-	float averageOutDegree = 0;
-	for (size_t i = 0; i < m_adjacencyMatrix.size(); ++i)
+	std::vector<std::vector<int>> adjacencyMatrix(m_nodes.size(), std::vector<int>(m_nodes.size(), 0));
+	for (const Edge& edge : m_edges)
 	{
-		unsigned int inDegreeCounter = 0;
-		unsigned int outDegreeCounter = 0;
-		for (size_t j = 0; j < m_adjacencyMatrix.size(); ++j)
+		adjacencyMatrix[edge.start->index][edge.end->index] = edge.weight;
+	}
+	return adjacencyMatrix;
+}
+
+bool Graph::hasEdge(size_t start, size_t end) const
+{
+	if (m_denseAdjacency)
+	{
+		return m_adjacencyBits.test(start, end);
+	}
+	if (m_topologyStale)
+	{
+		return findEdge(start, end) >= 0;
+	}
+
+	// Rows of the CSR are sorted, so this is O(log(degree)).
+	auto rowBegin = m_outAdjacency.neighbors.begin() + m_outAdjacency.offsets[start];
+	auto rowEnd = m_outAdjacency.neighbors.begin() + m_outAdjacency.offsets[start + 1];
+	return std::binary_search(rowBegin, rowEnd, static_cast<unsigned int>(end));
+}
+
+int Graph::findEdge(size_t start, size_t end) const
+{
+	if (m_denseAdjacency && !m_adjacencyBits.test(start, end))
+	{
+		return -1;
+	}
+
+	// Scan the shorter of the two lists.
+	const Node& startNode = m_nodes[start];
+	const Node& endNode = m_nodes[end];
+	if (startNode.outEdges.size() <= endNode.inEdges.size())
+	{
+		for (const Edge* edge : startNode.outEdges)
 		{
-			if (m_adjacencyMatrix[i][j] != 0)
+			if (edge->end == &endNode)
 			{
-				outDegreeCounter++;
+				return static_cast<int>(edge->index);
 			}
-			if (m_adjacencyMatrix[j][i] != 0)
+		}
+	}
+	else
+	{
+		for (const Edge* edge : endNode.inEdges)
+		{
+			if (edge->start == &startNode)
 			{
-				inDegreeCounter++;
+				return static_cast<int>(edge->index);
 			}
 		}
-		if (inDegreeCounter < minimumInDegree) { minimumInDegree = inDegreeCounter; }
-		if (outDegreeCounter < minimumOutDegree) { minimumOutDegree = outDegreeCounter; }
-		if (inDegreeCounter + outDegreeCounter < minimumDegree) { minimumDegree = inDegreeCounter + outDegreeCounter; }
-		if (inDegreeCounter >= maximumInDegree) { maximumInDegree = inDegreeCounter; }
-		if (outDegreeCounter >= maximumOutDegree) { maximumOutDegree = outDegreeCounter; }
-		if (inDegreeCounter + outDegreeCounter >= maximumDegree) { maximumDegree = inDegreeCounter + outDegreeCounter; }
-
-		averageInDegree += float(inDegreeCounter);
-		averageOutDegree += float(outDegreeCounter);
-	}
-	m_minimumInDegree = minimumInDegree;
-	m_minimumOutDegree = minimumOutDegree;
-	m_minimumDegree = minimumDegree;
-
-	m_averageInDegree = averageInDegree / float(m_adjacencyMatrix.size());
-	m_averageOutDegree = averageOutDegree / float(m_adjacencyMatrix.size());
-	m_averageDegree = m_averageInDegree + m_averageOutDegree;
-
-	m_maximumDegree = maximumDegree;
-	m_maximumInDegree = maximumInDegree;
-	m_maximumOutDegree = maximumOutDegree;
-}
\ No newline at end of file
+	}
+	return -1;
+}
+
+void Graph::setDenseAdjacency(bool enabled)
+{
+	m_denseAdjacency = enabled;
+	if (!enabled)
+	{
+		m_adjacencyBits.clear();
+		return;
+	}
+
+	m_adjacencyBits.assign(m_nodes.size());
+	for (const Edge& edge : m_edges)
+	{
+		m_adjacencyBits.set(edge.start->index, edge.end->index);
+	}
+}
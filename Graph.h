@@ -2,23 +2,67 @@
 
 #include "Settings.h"
 #include "NodeAndEdge.h"
+#include "SparseMatrix.h"
+#include "GraphFile.h"
+#include "LayoutEngine.h"
+#include "GraphSnapshot.h"
+#include "SpatialGrid.h"
+#include "ViewCuller.h"
+#include "PropertyMap.h"
+#include "DegreeStatistics.h"
+#include "AdjacencyBitset.h"
 #include <vector>
 #include <random>
 #include <string>
 
-// IMPORTANT: FOR NOW, ONCE YOU GET A NODE FROM THE GRAPH, DO NOT MESS WITH ITS CONNECTIONS.
-// THE GRAPH IS NOT CODED TO ADAPTIVELY CHANGE ITS EDGES AND SO ON.
-// CONSIDER THE GRAPH AS IMMUTABLE AND ONLY IMPLEMENT READ-ONLY ALGORITHMS.
+// IMPORTANT: CHANGE THE CONNECTIONS ONLY THROUGH addNode/removeNode/addEdge/removeEdge, NEVER BY EDITING
+// Node::inEdges/outEdges OR Edge::start/end. INDICES STAY DENSE: REMOVING A NODE OR AN EDGE MOVES THE LAST ONE
+// INTO ITS PLACE, AND ADDING MAY REALLOCATE. SO INDICES, REFERENCES AND POINTERS TAKEN BEFORE A CHANGE ARE STALE AFTER IT.
 
 class Graph : public sf::Drawable, public sf::Transformable
 {
 public:
 	explicit Graph(const std::vector<std::vector<int>>& adjacencyMatrix);
-	explicit Graph(const std::string& path);
+	explicit Graph(const SparseMatrix& adjacency);
+	// Reads a graph file, see GraphFile.h for the formats. Throws std::runtime_error if the file is malformed.
+	explicit Graph(const std::string& path, GraphFile::Format format = GraphFile::Format::Auto);
 
-	std::vector<std::vector<int>>& getAdjacencyMatrix()
+	// Writes the graph and its current layout in the binary format of GraphFile.h.
+	// Loading the file again skips the initial physics iterations.
+	void save(const std::string& path) const;
+
+	// The graph is stored sparsely, the dense matrix is built on every call. O(N^2), avoid for large graphs.
+	std::vector<std::vector<int>> getAdjacencyMatrix() const;
+	// Rebuilt on first use after the topology changed, O(N + M) once per batch of changes.
+	const CompressedAdjacency& getOutAdjacency() const
+	{
+		refreshTopology();
+		return m_outAdjacency;
+	}
+	const CompressedAdjacency& getInAdjacency() const
 	{
-		return m_adjacencyMatrix;
+		refreshTopology();
+		return m_inAdjacency;
+	}
+	// O(1) with the dense adjacency. Otherwise O(log(degree)), O(degree) between a change and the next rebuild
+	// of the compressed adjacency.
+	bool hasEdge(size_t start, size_t end) const;
+	// Index of the edge start -> end, -1 if there is none. O(degree), O(1) for a missing edge with the dense adjacency.
+	int findEdge(size_t start, size_t end) const;
+	// Dense adjacency: a bit matrix of the edges (see AdjacencyBitset.h) kept alongside the sparse structures.
+	// It is turned on at construction for graphs at least Settings::DENSE_ADJACENCY_DENSITY dense with at most
+	// Settings::DENSE_ADJACENCY_MAX_NODES nodes, and kept up to date by every change while on.
+	void setDenseAdjacency(bool enabled);
+	// nullptr while the dense adjacency is off.
+	const AdjacencyBitset* getDenseAdjacency() const { return m_denseAdjacency ? &m_adjacencyBits : nullptr; }
+	// Counts the topology changes, so results computed from the topology can tell whether they are still current.
+	unsigned long long getTopologyVersion() const { return m_topologyVersion; }
+	// Counts the node removals. Indices kept across a removal may refer to another node, or to none.
+	unsigned long long getNumOfNodeRemovals() const { return m_numOfNodeRemovals; }
+	// Index of the edge going the opposite way (end -> start), -1 if there is none.
+	int getReverseEdge(size_t index) const
+	{
+		return m_reverseEdges[index];
 	}
 	Node& getNode(size_t index)
 	{
@@ -28,63 +72,145 @@ public:
 	{
 		return m_edges[index];
 	}
+	const Node& getNode(size_t index) const
+	{
+		return m_nodes[index];
+	}
+	const Edge& getEdge(size_t index) const
+	{
+		return m_edges[index];
+	}
+
+	// Topology changes. Node::inEdges/outEdges, the vertex arrays, the spatial index, the reverse edges and the degree
+	// statistics are updated right away. The compressed adjacency is rebuilt lazily, so rewiring many edges and
+	// then stepping the layout pays the O(N + M) rebuild once.
+	// The new node is placed at position, or at a random position like the initial layout. Returns its index.
+	unsigned int addNode();
+	unsigned int addNode(sf::Vector2f position);
+	// Also removes the edges of the node. O(sum of the degrees of the node and its neighbors).
+	void removeNode(size_t index);
+	// Adds start -> end, or only sets the weight if the edge exists. Returns the index of the edge, -1 for a
+	// self-loop (they are not drawn) or a node that does not exist. O(degree of start + degree of end).
+	int addEdge(size_t start, size_t end, int weight = 1);
+	// O(degree of its start + degree of its end).
+	void removeEdge(size_t index);
+
+	// Simulation state as typed columns indexed like the nodes / edges, see PropertyMap.h. For example
+	// Property<float>& opinion = graph.addNodeProperty<float>("opinion"); then opinion[i] belongs to node i.
+	// Adding or removing nodes / edges keeps the columns in step, new entries get the default value.
+	// A column reference stays valid until the column is removed, its data() only until nodes / edges are added or removed.
+	template<typename T>
+	Property<T>& addNodeProperty(const std::string& name, const T& defaultValue = T{})
+	{
+		return m_nodeProperties.add<Property<T>>(name, defaultValue);
+	}
+	template<typename T>
+	DoubleBufferedProperty<T>& addDoubleBufferedNodeProperty(const std::string& name, const T& defaultValue = T{})
+	{
+		return m_nodeProperties.add<DoubleBufferedProperty<T>>(name, defaultValue);
+	}
+	template<typename T>
+	Property<T>& addEdgeProperty(const std::string& name, const T& defaultValue = T{})
+	{
+		return m_edgeProperties.add<Property<T>>(name, defaultValue);
+	}
+	template<typename T>
+	DoubleBufferedProperty<T>& addDoubleBufferedEdgeProperty(const std::string& name, const T& defaultValue = T{})
+	{
+		return m_edgeProperties.add<DoubleBufferedProperty<T>>(name, defaultValue);
+	}
+	// Lookup and removal, e.g. getNodeProperties().find<Property<float>>("opinion").
+	PropertyMap& getNodeProperties() { return m_nodeProperties; }
+	PropertyMap& getEdgeProperties() { return m_edgeProperties; }
 
 	void updateGeometry(int nodeHeld = -1, sf::Vector2f inject = { 0, 0 });
-	int findClosestNode(sf::Vector2f position, float tolerance = 10.0f) const;
+	void setExactRepulsion(bool exact) { m_layout.setExactRepulsion(exact); }
+	void setBarnesHutTheta(float theta) { m_layout.setBarnesHutTheta(theta); }
+	// Spatial queries on node positions, answered by a grid that updateGeometry keeps up to date.
+	// Distances are in world units. If you move nodes yourself, call updateSpatialIndex afterwards.
+	int findClosestNode(sf::Vector2f position, float tolerance = 3.0f) const;
+	void findNodesInRadius(sf::Vector2f center, float radius, std::vector<unsigned int>& result) const;
+	void findNodesInRect(const sf::FloatRect& rect, std::vector<unsigned int>& result) const;
+	void updateSpatialIndex();
+
+	// Copies the vertex arrays and weight labels. Reuses the snapshot's memory when the sizes match.
+	void takeSnapshot(GraphSnapshot& snapshot) const;
+	// World position of the weight label and the weight of every edge.
+	void getEdgeLabels(std::vector<sf::Vector2f>& positions, std::vector<int>& weights) const;
 
 	void setNodeColor(size_t index, sf::Color color, float alpha = 1.0f);
 	void setEdgeColor(size_t index, sf::Color color, float alpha = 1.0f);
 
 	int getNumOfEdges() const { return m_edges.size(); }
 	int getNumOfNodes() const { return m_nodes.size();}
-	unsigned int getMinimumDegree() const { return m_minimumDegree; }
-	unsigned int getMinimumInDegree() const { return m_minimumInDegree; }
-	unsigned int getMinimumOutDegree() const { return m_minimumOutDegree; }
-	float getAverageDegree() const { return m_averageDegree; }
-	float getAverageInDegree() const { return m_averageInDegree; }
-	float getAverageOutDegree() const { return m_averageOutDegree; }
-	unsigned int getMaximumDegree() const { return m_maximumDegree; }
-	unsigned int getMaximumInDegree() const { return m_maximumInDegree; }
-	unsigned int getMaximumOutDegree() const { return m_maximumOutDegree; }
+	// Kept up to date by every change, all O(1). See DegreeStatistics.h for histograms and percentiles.
+	unsigned int getDegree(size_t index) const { return m_degrees.getDegree(index); }
+	unsigned int getInDegree(size_t index) const { return m_degrees.getInDegree(index); }
+	unsigned int getOutDegree(size_t index) const { return m_degrees.getOutDegree(index); }
+	const DegreeStatistics& getDegreeStatistics() const { return m_degrees; }
+	unsigned int getMinimumDegree() const { return m_degrees.getMinimum(DegreeStatistics::Kind::Total); }
+	unsigned int getMinimumInDegree() const { return m_degrees.getMinimum(DegreeStatistics::Kind::In); }
+	unsigned int getMinimumOutDegree() const { return m_degrees.getMinimum(DegreeStatistics::Kind::Out); }
+	float getAverageDegree() const { return m_degrees.getAverage(DegreeStatistics::Kind::Total); }
+	float getAverageInDegree() const { return m_degrees.getAverage(DegreeStatistics::Kind::In); }
+	float getAverageOutDegree() const { return m_degrees.getAverage(DegreeStatistics::Kind::Out); }
+	unsigned int getMaximumDegree() const { return m_degrees.getMaximum(DegreeStatistics::Kind::Total); }
+	unsigned int getMaximumInDegree() const { return m_degrees.getMaximum(DegreeStatistics::Kind::In); }
+	unsigned int getMaximumOutDegree() const { return m_degrees.getMaximum(DegreeStatistics::Kind::Out); }
 
 private:
 	std::vector<Node> m_nodes;
 	std::vector<Edge> m_edges;
-	std::vector<std::vector<int>> m_adjacencyMatrix;
+	std::vector<int> m_reverseEdges;
+	AdjacencyBitset m_adjacencyBits;
+	bool m_denseAdjacency = false;
+	PropertyMap m_nodeProperties;
+	PropertyMap m_edgeProperties;
+
+	// Derived from the node and edge lists, rebuilt by refreshTopology when stale.
+	mutable CompressedAdjacency m_outAdjacency;
+	mutable CompressedAdjacency m_inAdjacency;
+	mutable bool m_topologyStale = true;
+	unsigned long long m_topologyVersion = 0;
+	unsigned long long m_numOfNodeRemovals = 0;
 
 	// Important parameters
-	unsigned int m_minimumDegree;
-	unsigned int m_minimumInDegree;
-	unsigned int m_minimumOutDegree;
-	unsigned int m_maximumDegree;
-	unsigned int m_maximumInDegree;
-	unsigned int m_maximumOutDegree;
-	float m_averageDegree;
-	float m_averageInDegree;
-	float m_averageOutDegree;
+	DegreeStatistics m_degrees;
 	
 	// Visual 
 	float m_nodeSize = Settings::NODE_SIZE;
 	float m_edgeThickness = Settings::EDGE_THICKNESS;
-	float m_areaSize;
-	float m_attraction = Settings::ATTRACTION_FORCE;
-	float m_repulsion = Settings::REPULSION_FORCE;
+	float m_areaSize = 0.0f;
 	int m_iterations = Settings::NUMBER_OF_PHYSICS_ITERATIONS;
+	LayoutEngine m_layout;
+	SpatialGrid m_spatialIndex{ Settings::SPATIAL_GRID_CELL_SIZE };
 
 	// Rendering
 	sf::VertexArray m_nodeVertices;
 	sf::VertexArray m_edgeVertices;
+	std::vector<ViewCuller::Bounds> m_nodeBounds;
+	std::vector<ViewCuller::Bounds> m_edgeBounds;
+	mutable ViewCuller m_culler;
 
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 	void setVertexPositionsOfNode(size_t i);
-	void setVertexPositionsOfEdge(size_t i, bool second = false);
-	void readAdjacencyMatrixFromFile(const std::string& path);
-	void adjacencyMatrixToGeometry();
+	void setVertexPositionsOfEdge(size_t i);
+	explicit Graph(const GraphFile::Contents& file);
+	Graph(const SparseMatrixView& adjacency, const float* positions);
+	void adjacencyMatrixToGeometry(const SparseMatrixView& adjacency, const float* positions);
+	void buildReverseEdges();
+	void refreshTopology() const;
+	void rebuildAdjacency() const;
+	void topologyChanged();
+	// Grow the vectors by hand so the Node/Edge pointers can be moved to the new storage.
+	void reserveNodes(size_t count);
+	void reserveEdges(size_t count);
+	// Moves the last edge into the slot at index, the caller pops the back.
+	void moveLastEdge(size_t index);
 
 	// Helpers.
 	float randFloat()
 	{
 		return static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
 	}
-	void calculateImportantParameters();
 };
\ No newline at end of file
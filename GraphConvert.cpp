@@ -0,0 +1,56 @@
+// GraphConvert.cpp : Converts graph files (text adjacency matrices, edge lists, Matrix Market) to the binary
+// graph format (see GraphFile.h).
+// Usage: GraphConvert <input> <output> [auto|matrix|edgelist|mtx|binary]
+
+#include "GraphFile.h"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+
+bool ParseFormat(const std::string& name, GraphFile::Format& format)
+{
+    if (name == "auto")
+        format = GraphFile::Format::Auto;
+    else if (name == "matrix")
+        format = GraphFile::Format::AdjacencyMatrix;
+    else if (name == "edgelist" || name == "snap")
+        format = GraphFile::Format::EdgeList;
+    else if (name == "mtx")
+        format = GraphFile::Format::MatrixMarket;
+    else if (name == "binary")
+        format = GraphFile::Format::Binary;
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    GraphFile::Format format = GraphFile::Format::Auto;
+    if ((argc != 3 && argc != 4) || (argc == 4 && !ParseFormat(argv[3], format)))
+    {
+        std::cerr << "Usage: " << argv[0] << " <input> <output> [auto|matrix|edgelist|mtx|binary]" << std::endl;
+        std::cerr << "Reads a graph file and writes it as a binary graph file. The input format is detected by default." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        auto start = std::chrono::steady_clock::now();
+        GraphFile::Contents contents = GraphFile::Load(argv[1], format);
+        SparseMatrixView adjacency = contents.getAdjacency();
+        GraphFile::Write(argv[2], adjacency, contents.getPositions());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Wrote " << adjacency.numOfRows << " nodes and " << adjacency.getNumOfEntries() << " edges to "
+            << argv[2] << " in " << seconds << " s." << std::endl;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,8 +5,8 @@
 
 int main()
 {
-    std::vector<std::vector<int>> adjacencyMatrix = GraphGeneration::GenerateRandomGraph(200, 0.01, 4);
-    Graph graph{ adjacencyMatrix };
+    SparseMatrix adjacency = GraphGeneration::GenerateSparseRandomGraph(200, 0.01, 4);
+    Graph graph{ adjacency };
     Simulation simulation{ &graph };
 
     simulation.run();
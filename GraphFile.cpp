@@ -0,0 +1,827 @@
+#include "GraphFile.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "Graph files are little-endian and read in place.");
+
+namespace GraphFile
+{
+	namespace
+	{
+		[[noreturn]] void Fail(const std::string& path, const std::string& reason)
+		{
+			throw std::runtime_error("ERROR::GRAPH FILE " + path + ": " + reason);
+		}
+
+		bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+		}
+
+		// Rows are converted to CSR as they are parsed, the dense matrix is never held in memory.
+		SparseMatrix ParseTextMatrix(const char* cursor, const char* const end, const std::string& path)
+		{
+			SparseMatrix adjacency;
+			size_t numOfColumns = 0;
+			size_t lineNumber = 0;
+
+			while (cursor < end)
+			{
+				const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+				if (!lineEnd)
+				{
+					lineEnd = end;
+				}
+				lineNumber++;
+
+				// Parse one row straight into CSR.
+				size_t column = 0;
+				const char* p = cursor;
+				while (true)
+				{
+					while (p < lineEnd && IsSpace(*p))
+					{
+						p++;
+					}
+					if (p == lineEnd)
+					{
+						break;
+					}
+					if (*p == '+')
+					{
+						p++;
+					}
+					int value;
+					auto [next, error] = std::from_chars(p, lineEnd, value);
+					if (error != std::errc{} || (next < lineEnd && !IsSpace(*next)))
+					{
+						Fail(path, "LINE " + std::to_string(lineNumber) + " CONTAINS A NON-INTEGER");
+					}
+					if (numOfColumns > 0 && column >= numOfColumns)
+					{
+						Fail(path, "LINE " + std::to_string(lineNumber) + " HAS MORE THAN " + std::to_string(numOfColumns) + " INTEGERS");
+					}
+					if (value != 0)
+					{
+						adjacency.columns.push_back(static_cast<unsigned int>(column));
+						adjacency.values.push_back(value);
+					}
+					column++;
+					p = next;
+				}
+				cursor = lineEnd + 1;
+
+				if (column == 0)
+				{
+					continue;	// Blank lines are allowed.
+				}
+				if (numOfColumns == 0)
+				{
+					numOfColumns = column;	// The first row determines N.
+				}
+				else if (column != numOfColumns)
+				{
+					Fail(path, "LINE " + std::to_string(lineNumber) + " HAS " + std::to_string(column) + " INTEGERS INSTEAD OF " + std::to_string(numOfColumns));
+				}
+				adjacency.offsets.push_back(static_cast<unsigned int>(adjacency.columns.size()));
+			}
+
+			if (numOfColumns == 0)
+			{
+				Fail(path, "FILE APPEARS TO BE EMPTY");
+			}
+			adjacency.numOfRows = static_cast<unsigned int>(adjacency.offsets.size() - 1);
+			if (adjacency.numOfRows != numOfColumns)
+			{
+				Fail(path, "MATRIX HAS " + std::to_string(adjacency.numOfRows) + " ROWS AND " + std::to_string(numOfColumns) + " COLUMNS");
+			}
+			return adjacency;
+		}
+
+		const char* SkipSpaces(const char* p, const char* end)
+		{
+			while (p < end && IsSpace(*p))
+			{
+				p++;
+			}
+			return p;
+		}
+
+		// Reads the next whitespace-separated number of a line. False if there is none or it is malformed.
+		template<typename T>
+		bool ParseNumber(const char*& p, const char* end, T& value)
+		{
+			p = SkipSpaces(p, end);
+			if (p < end && *p == '+')
+			{
+				p++;
+			}
+			auto [next, error] = std::from_chars(p, end, value);
+			if (error != std::errc{} || (next < end && !IsSpace(*next)))
+			{
+				return false;
+			}
+			p = next;
+			return true;
+		}
+
+		bool IsLineEmpty(const char* p, const char* end)
+		{
+			return SkipSpaces(p, end) == end;
+		}
+
+		std::vector<std::string> SplitLowercase(const char* p, const char* end)
+		{
+			std::vector<std::string> tokens;
+			while ((p = SkipSpaces(p, end)) < end)
+			{
+				std::string token;
+				for (; p < end && !IsSpace(*p); ++p)
+				{
+					token.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(*p))));
+				}
+				tokens.push_back(token);
+			}
+			return tokens;
+		}
+
+		const char* FindLineEnd(const char* p, const char* end)
+		{
+			const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			return newline ? newline : end;
+		}
+
+		// An edge as written in the file, before node ids are remapped.
+		struct RawEdge
+		{
+			std::uint64_t from;
+			std::uint64_t to;
+			int weight;
+		};
+
+		struct Chunk
+		{
+			std::vector<RawEdge> edges;
+			const char* error = nullptr;	// First malformed line, if any.
+		};
+
+		// Splits [begin, end) of the file starting at fileBegin into chunks of whole lines and parses them in parallel. The chunks keep the order of the
+		// file, so duplicate edges resolve the same way for any number of threads.
+		// parseLine(line, lineEnd, edges) appends the edges of a line and returns false if the line is malformed.
+		template<typename ParseLine>
+		std::vector<Chunk> ParseLinesInParallel(const char* fileBegin, const char* begin, const char* end, const std::string& path, const ParseLine& parseLine)
+		{
+			constexpr std::ptrdiff_t CHUNK_SIZE = 1 << 20;
+
+			std::vector<const char*> starts{ begin };
+			while (end - starts.back() > CHUNK_SIZE)
+			{
+				starts.push_back(FindLineEnd(starts.back() + CHUNK_SIZE, end) + 1);
+			}
+			if (starts.back() < end)
+			{
+				starts.push_back(end);
+			}
+
+			std::vector<Chunk> chunks(starts.size() - 1);
+			ThreadPool::getGlobal().parallelFor(0, chunks.size(), [&](size_t first, size_t last, unsigned int)
+				{
+					for (size_t c = first; c < last; ++c)
+					{
+						const char* cursor = starts[c];
+						const char* chunkEnd = std::min(starts[c + 1], end);
+						chunks[c].edges.reserve(static_cast<size_t>(chunkEnd - cursor) / 16);
+						while (cursor < chunkEnd)
+						{
+							const char* lineEnd = FindLineEnd(cursor, chunkEnd);
+							if (!parseLine(cursor, lineEnd, chunks[c].edges))
+							{
+								chunks[c].error = cursor;
+								break;
+							}
+							cursor = lineEnd + 1;
+						}
+					}
+				}, 1);
+
+			// Errors are thrown here rather than from the workers. Line numbers are counted only then.
+			for (const Chunk& chunk : chunks)
+			{
+				if (chunk.error)
+				{
+					size_t lineNumber = 1 + std::count(fileBegin, chunk.error, '\n');
+					Fail(path, "LINE " + std::to_string(lineNumber) + " IS MALFORMED");
+				}
+			}
+			return chunks;
+		}
+
+		// Builds the CSR matrix of the parsed edges. With remap, node ids are mapped to 0 .. N-1 in increasing order,
+		// otherwise they are used as they are and there are numOfNodes nodes. A non-zero mirrorSign adds the edge
+		// to -> from with weight mirrorSign * weight for every edge that is not a self-loop.
+		SparseMatrix BuildMatrix(const std::vector<Chunk>& chunks, std::uint64_t numOfNodes, bool remap, int mirrorSign, const std::string& path)
+		{
+			std::vector<size_t> firsts(chunks.size() + 1, 0);
+			std::uint64_t maxId = 0;
+			for (size_t c = 0; c < chunks.size(); ++c)
+			{
+				size_t numOfChunkEdges = 0;
+				for (const RawEdge& edge : chunks[c].edges)
+				{
+					maxId = std::max({ maxId, edge.from, edge.to });
+					numOfChunkEdges += (mirrorSign != 0 && edge.from != edge.to) ? 2 : 1;
+				}
+				firsts[c + 1] = firsts[c] + numOfChunkEdges;
+			}
+			const size_t numOfEdges = firsts.back();
+			if (numOfEdges == 0 && numOfNodes == 0)
+			{
+				Fail(path, "FILE CONTAINS NO EDGES");
+			}
+
+			// Ids are looked up in a table when they are reasonably dense, otherwise in the sorted list of used ids.
+			std::vector<unsigned int> table;
+			std::vector<std::uint64_t> ids;
+			if (remap)
+			{
+				if (maxId < 8 * static_cast<std::uint64_t>(numOfEdges) + 1024)
+				{
+					table.assign(static_cast<size_t>(maxId) + 1, 0);
+					for (const Chunk& chunk : chunks)
+					{
+						for (const RawEdge& edge : chunk.edges)
+						{
+							table[edge.from] = 1;
+							table[edge.to] = 1;
+						}
+					}
+					std::uint64_t next = 0;
+					for (unsigned int& entry : table)
+					{
+						unsigned int used = entry;
+						entry = static_cast<unsigned int>(next);
+						next += used;
+					}
+					numOfNodes = next;
+				}
+				else
+				{
+					ids.reserve(2 * numOfEdges);
+					for (const Chunk& chunk : chunks)
+					{
+						for (const RawEdge& edge : chunk.edges)
+						{
+							ids.push_back(edge.from);
+							ids.push_back(edge.to);
+						}
+					}
+					std::sort(ids.begin(), ids.end());
+					ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+					numOfNodes = ids.size();
+				}
+			}
+			if (numOfNodes >= 0xFFFFFFFFull || numOfEdges > 0xFFFFFFFFull)
+			{
+				Fail(path, "TOO MANY NODES OR EDGES");
+			}
+
+			auto map = [&](std::uint64_t id) -> unsigned int
+				{
+					if (!remap)
+					{
+						return static_cast<unsigned int>(id);
+					}
+					if (!table.empty())
+					{
+						return table[id];
+					}
+					return static_cast<unsigned int>(std::lower_bound(ids.begin(), ids.end(), id) - ids.begin());
+				};
+
+			std::vector<SparseEntry> entries(numOfEdges);
+			ThreadPool::getGlobal().parallelFor(0, chunks.size(), [&](size_t first, size_t last, unsigned int)
+				{
+					for (size_t c = first; c < last; ++c)
+					{
+						SparseEntry* out = entries.data() + firsts[c];
+						for (const RawEdge& edge : chunks[c].edges)
+						{
+							*out++ = { map(edge.from), map(edge.to), edge.weight };
+							if (mirrorSign != 0 && edge.from != edge.to)
+							{
+								*out++ = { map(edge.to), map(edge.from), mirrorSign * edge.weight };
+							}
+						}
+					}
+				}, 1);
+
+			return SparseMatrix::fromEntries(static_cast<unsigned int>(numOfNodes), std::move(entries));
+		}
+
+		SparseMatrix ParseEdgeList(const char* begin, const char* end, const std::string& path)
+		{
+			auto parseLine = [](const char* p, const char* lineEnd, std::vector<RawEdge>& edges)
+				{
+					p = SkipSpaces(p, lineEnd);
+					if (p == lineEnd || *p == '#' || *p == '%')
+					{
+						return true;
+					}
+					RawEdge edge{ 0, 0, 1 };
+					if (!ParseNumber(p, lineEnd, edge.from) || !ParseNumber(p, lineEnd, edge.to))
+					{
+						return false;
+					}
+					if (!IsLineEmpty(p, lineEnd) && !ParseNumber(p, lineEnd, edge.weight))
+					{
+						return false;
+					}
+					edges.push_back(edge);
+					return IsLineEmpty(p, lineEnd);
+				};
+
+			return BuildMatrix(ParseLinesInParallel(begin, begin, end, path, parseLine), 0, true, 0, path);
+		}
+
+		SparseMatrix ParseMatrixMarket(const char* begin, const char* end, const std::string& path)
+		{
+			// Banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+			const char* cursor = begin;
+			const char* lineEnd = FindLineEnd(cursor, end);
+			std::vector<std::string> banner = SplitLowercase(cursor, lineEnd);
+			if (banner.size() != 5 || banner[0] != "%%matrixmarket" || banner[1] != "matrix")
+			{
+				Fail(path, "MISSING MATRIX MARKET BANNER");
+			}
+			if (banner[2] != "coordinate")
+			{
+				Fail(path, "ONLY THE COORDINATE MATRIX MARKET FORMAT IS SUPPORTED");
+			}
+			const std::string& field = banner[3];
+			const std::string& symmetry = banner[4];
+			if (field != "integer" && field != "real" && field != "pattern")
+			{
+				Fail(path, "UNSUPPORTED MATRIX MARKET FIELD " + field);
+			}
+			if (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric")
+			{
+				Fail(path, "UNSUPPORTED MATRIX MARKET SYMMETRY " + symmetry);
+			}
+
+			// Comments, then the size line: rows columns entries
+			std::uint64_t numOfRows = 0;
+			std::uint64_t numOfColumns = 0;
+			std::uint64_t numOfEntries = 0;
+			while (true)
+			{
+				cursor = lineEnd + 1;
+				if (cursor >= end)
+				{
+					Fail(path, "MISSING MATRIX MARKET SIZE LINE");
+				}
+				lineEnd = FindLineEnd(cursor, end);
+				const char* p = SkipSpaces(cursor, lineEnd);
+				if (p == lineEnd || *p == '%')
+				{
+					continue;
+				}
+				if (!ParseNumber(p, lineEnd, numOfRows) || !ParseNumber(p, lineEnd, numOfColumns) || !ParseNumber(p, lineEnd, numOfEntries)
+					|| !IsLineEmpty(p, lineEnd))
+				{
+					Fail(path, "MALFORMED MATRIX MARKET SIZE LINE");
+				}
+				break;
+			}
+			cursor = std::min(lineEnd + 1, end);
+
+			// Entries: row column [value], 1-based. Symmetric matrices only store one triangle.
+			const bool isPattern = field == "pattern";
+			const bool isReal = field == "real";
+			const int mirrorSign = symmetry == "general" ? 0 : symmetry == "skew-symmetric" ? -1 : 1;
+			auto parseLine = [&](const char* p, const char* lineEnd, std::vector<RawEdge>& edges)
+				{
+					p = SkipSpaces(p, lineEnd);
+					if (p == lineEnd || *p == '%')
+					{
+						return true;
+					}
+					RawEdge edge{ 0, 0, 1 };
+					if (!ParseNumber(p, lineEnd, edge.from) || !ParseNumber(p, lineEnd, edge.to)
+						|| edge.from < 1 || edge.from > numOfRows || edge.to < 1 || edge.to > numOfColumns)
+					{
+						return false;
+					}
+					edge.from--;
+					edge.to--;
+					if (isReal)
+					{
+						double value;
+						if (!ParseNumber(p, lineEnd, value))
+						{
+							return false;
+						}
+						edge.weight = static_cast<int>(std::lround(value));
+						if (edge.weight == 0 && value != 0.0)
+						{
+							edge.weight = value > 0.0 ? 1 : -1;
+						}
+					}
+					else if (!isPattern && !ParseNumber(p, lineEnd, edge.weight))
+					{
+						return false;
+					}
+					edges.push_back(edge);
+					return IsLineEmpty(p, lineEnd);
+				};
+
+			std::vector<Chunk> chunks = ParseLinesInParallel(begin, cursor, end, path, parseLine);
+
+			size_t numOfParsed = 0;
+			for (const Chunk& chunk : chunks)
+			{
+				numOfParsed += chunk.edges.size();
+			}
+			if (numOfParsed != numOfEntries)
+			{
+				Fail(path, "SIZE LINE ANNOUNCES " + std::to_string(numOfEntries) + " ENTRIES BUT THE FILE HAS " + std::to_string(numOfParsed));
+			}
+			return BuildMatrix(chunks, std::max(numOfRows, numOfColumns), false, mirrorSign, path);
+		}
+	}
+
+	// ---------- MappedFile ----------
+
+	MappedFile::MappedFile(const std::string& path)
+	{
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			Fail(path, "COULD NOT OPEN FILE");
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			Fail(path, "COULD NOT READ FILE SIZE");
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+		if (m_size > 0)
+		{
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping)
+			{
+				m_data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				CloseHandle(mapping);	// The view keeps the mapping alive.
+			}
+		}
+		CloseHandle(file);
+#else
+		int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			Fail(path, "COULD NOT OPEN FILE");
+		}
+		struct stat status;
+		if (::fstat(file, &status) != 0)
+		{
+			::close(file);
+			Fail(path, "COULD NOT READ FILE SIZE");
+		}
+		m_size = static_cast<size_t>(status.st_size);
+		if (m_size > 0)
+		{
+			void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+			m_data = data == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(data);
+		}
+		::close(file);	// The mapping stays valid.
+#endif
+		if (m_size > 0 && !m_data)
+		{
+			Fail(path, "COULD NOT MAP FILE");
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: m_data{ other.m_data }, m_size{ other.m_size }
+	{
+		other.m_data = nullptr;
+		other.m_size = 0;
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			m_data = other.m_data;
+			m_size = other.m_size;
+			other.m_data = nullptr;
+			other.m_size = 0;
+		}
+		return *this;
+	}
+
+	void MappedFile::close()
+	{
+		if (m_data)
+		{
+#if defined(_WIN32)
+			UnmapViewOfFile(m_data);
+#else
+			::munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+		}
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	// ---------- Loading ----------
+
+	namespace
+	{
+		// Edge list or adjacency matrix, from the first lines. Comments only occur in edge lists. Otherwise lines of
+		// 2 or 3 numbers are an edge list, unless there are exactly as many lines as numbers per line: such a file
+		// is a valid matrix and a valid edge list, and the caller has to say which.
+		Format DetectTextFormat(const char* cursor, const char* const end, const std::string& path)
+		{
+			constexpr size_t MAXIMUM_EDGE_LIST_COLUMNS = 3;
+			size_t numOfLines = 0;
+			size_t numOfColumns = 0;
+			bool sameColumns = true;
+			while (cursor < end && numOfLines <= MAXIMUM_EDGE_LIST_COLUMNS)
+			{
+				const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+				if (!lineEnd)
+				{
+					lineEnd = end;
+				}
+
+				size_t columns = 0;
+				const char* p = SkipSpaces(cursor, lineEnd);
+				if (p < lineEnd && (*p == '#' || *p == '%'))
+				{
+					return Format::EdgeList;
+				}
+				while (p < lineEnd)
+				{
+					columns++;
+					while (p < lineEnd && !IsSpace(*p))
+					{
+						p++;
+					}
+					p = SkipSpaces(p, lineEnd);
+				}
+				cursor = lineEnd + 1;
+
+				if (columns == 0)
+				{
+					continue;
+				}
+				if (columns < 2 || columns > MAXIMUM_EDGE_LIST_COLUMNS)
+				{
+					return Format::AdjacencyMatrix;
+				}
+				sameColumns = sameColumns && (numOfColumns == 0 || columns == numOfColumns);
+				numOfColumns = columns;
+				numOfLines++;
+			}
+
+			if (numOfLines == 0)
+			{
+				return Format::AdjacencyMatrix;
+			}
+			if (sameColumns && numOfLines == numOfColumns)
+			{
+				Fail(path, "COULD BE AN ADJACENCY MATRIX OR AN EDGE LIST, PASS THE FORMAT EXPLICITLY");
+			}
+			return Format::EdgeList;
+		}
+	}
+
+	SparseMatrixView Contents::getAdjacency() const
+	{
+		if (!m_mapping.data())
+		{
+			return m_parsed.view();
+		}
+
+		const unsigned char* base = m_mapping.data();
+		SparseMatrixView view;
+		view.numOfRows = static_cast<unsigned int>(m_header.numOfNodes);
+		view.offsets = reinterpret_cast<const unsigned int*>(base + m_header.offsetsOffset);
+		view.columns = reinterpret_cast<const unsigned int*>(base + m_header.targetsOffset);
+		view.values = (m_header.flags & HAS_WEIGHTS) ? reinterpret_cast<const int*>(base + m_header.weightsOffset) : nullptr;
+		return view;
+	}
+
+	Contents Load(const std::string& path, Format format)
+	{
+		Contents contents;
+		MappedFile file{ path };
+		const char* text = reinterpret_cast<const char*>(file.data());
+		const char* end = text + file.size();
+
+		if (format == Format::Auto)
+		{
+			static constexpr char MATRIX_MARKET_BANNER[] = "%%MatrixMarket";
+			if (file.size() >= sizeof(MAGIC) && std::memcmp(text, MAGIC, sizeof(MAGIC)) == 0)
+			{
+				format = Format::Binary;
+			}
+			else if (file.size() >= sizeof(MATRIX_MARKET_BANNER) - 1 && std::memcmp(text, MATRIX_MARKET_BANNER, sizeof(MATRIX_MARKET_BANNER) - 1) == 0)
+			{
+				format = Format::MatrixMarket;
+			}
+			else
+			{
+				format = DetectTextFormat(text, end, path);
+			}
+		}
+
+		switch (format)
+		{
+		case Format::Binary:
+			contents.m_header = Validate(file, path);
+			contents.m_mapping = std::move(file);
+			if (contents.m_header.flags & HAS_POSITIONS)
+			{
+				contents.m_positions = reinterpret_cast<const float*>(contents.m_mapping.data() + contents.m_header.positionsOffset);
+			}
+			break;
+		case Format::EdgeList:
+			contents.m_parsed = ParseEdgeList(text, end, path);
+			break;
+		case Format::MatrixMarket:
+			contents.m_parsed = ParseMatrixMarket(text, end, path);
+			break;
+		default:
+			contents.m_parsed = ParseTextMatrix(text, end, path);
+			break;
+		}
+		return contents;
+	}
+
+	Header Validate(const MappedFile& file, const std::string& path)
+	{
+		if (file.size() < sizeof(Header))
+		{
+			Fail(path, "TRUNCATED HEADER");
+		}
+
+		Header header;
+		std::memcpy(&header, file.data(), sizeof(Header));
+		if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+		{
+			Fail(path, "NOT A BINARY GRAPH FILE");
+		}
+		if (header.version != VERSION)
+		{
+			Fail(path, "UNSUPPORTED VERSION " + std::to_string(header.version));
+		}
+		if (header.numOfNodes >= 0xFFFFFFFFull || header.numOfEdges > 0xFFFFFFFFull)
+		{
+			Fail(path, "TOO MANY NODES OR EDGES");
+		}
+
+		// Every section must lie inside the file and be aligned for in-place use.
+		auto checkSection = [&](std::uint64_t offset, std::uint64_t count, const char* name)
+			{
+				if (offset % 4 != 0 || offset < sizeof(Header) || offset > file.size() || count * 4 > file.size() - offset)
+				{
+					Fail(path, std::string("SECTION ") + name + " IS OUT OF BOUNDS OR MISALIGNED");
+				}
+			};
+		checkSection(header.offsetsOffset, header.numOfNodes + 1, "OFFSETS");
+		checkSection(header.targetsOffset, header.numOfEdges, "TARGETS");
+		if (header.flags & HAS_WEIGHTS)
+		{
+			checkSection(header.weightsOffset, header.numOfEdges, "WEIGHTS");
+		}
+		if (header.flags & HAS_POSITIONS)
+		{
+			checkSection(header.positionsOffset, 2 * header.numOfNodes, "POSITIONS");
+		}
+
+		// CSR structure, so that nothing downstream reads out of bounds.
+		const unsigned int* offsets = reinterpret_cast<const unsigned int*>(file.data() + header.offsetsOffset);
+		const unsigned int* targets = reinterpret_cast<const unsigned int*>(file.data() + header.targetsOffset);
+		if (offsets[0] != 0 || offsets[header.numOfNodes] != header.numOfEdges)
+		{
+			Fail(path, "OFFSETS DO NOT SPAN THE EDGES");
+		}
+		for (std::uint64_t i = 0; i < header.numOfNodes; ++i)
+		{
+			if (offsets[i + 1] < offsets[i])
+			{
+				Fail(path, "OFFSETS OF NODE " + std::to_string(i) + " ARE DECREASING");
+			}
+			for (unsigned int k = offsets[i]; k < offsets[i + 1]; ++k)
+			{
+				if (targets[k] >= header.numOfNodes)
+				{
+					Fail(path, "EDGE " + std::to_string(k) + " POINTS TO A NON-EXISTENT NODE");
+				}
+				if (k > offsets[i] && targets[k] <= targets[k - 1])
+				{
+					Fail(path, "TARGETS OF NODE " + std::to_string(i) + " ARE NOT SORTED OR CONTAIN DUPLICATES");
+				}
+			}
+		}
+		return header;
+	}
+
+	SparseMatrix ReadTextMatrix(const std::string& path)
+	{
+		MappedFile file{ path };
+		const char* text = reinterpret_cast<const char*>(file.data());
+		return ParseTextMatrix(text, text + file.size(), path);
+	}
+
+	SparseMatrix ReadEdgeList(const std::string& path)
+	{
+		MappedFile file{ path };
+		const char* text = reinterpret_cast<const char*>(file.data());
+		return ParseEdgeList(text, text + file.size(), path);
+	}
+
+	SparseMatrix ReadMatrixMarket(const std::string& path)
+	{
+		MappedFile file{ path };
+		const char* text = reinterpret_cast<const char*>(file.data());
+		return ParseMatrixMarket(text, text + file.size(), path);
+	}
+
+	// ---------- Writing ----------
+
+	void Write(const std::string& path, const SparseMatrixView& adjacency, const float* positions)
+	{
+		const std::uint64_t numOfNodes = adjacency.numOfRows;
+		const std::uint64_t numOfEdges = adjacency.getNumOfEntries();
+
+		Header header{};
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.flags = HAS_WEIGHTS | (positions ? HAS_POSITIONS : 0);
+		header.numOfNodes = numOfNodes;
+		header.numOfEdges = numOfEdges;
+		header.offsetsOffset = sizeof(Header);
+		header.targetsOffset = header.offsetsOffset + 4 * (numOfNodes + 1);
+		header.weightsOffset = header.targetsOffset + 4 * numOfEdges;
+		header.positionsOffset = positions ? header.weightsOffset + 4 * numOfEdges : 0;
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			Fail(path, "COULD NOT OPEN FILE FOR WRITING");
+		}
+
+		const unsigned int emptyOffset = 0;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		file.write(reinterpret_cast<const char*>(numOfNodes > 0 ? adjacency.offsets : &emptyOffset), 4 * (numOfNodes + 1));
+		file.write(reinterpret_cast<const char*>(adjacency.columns), 4 * numOfEdges);
+		if (adjacency.values)
+		{
+			file.write(reinterpret_cast<const char*>(adjacency.values), 4 * numOfEdges);
+		}
+		else
+		{
+			const std::vector<int> ones(numOfEdges, 1);
+			file.write(reinterpret_cast<const char*>(ones.data()), 4 * numOfEdges);
+		}
+		if (positions)
+		{
+			file.write(reinterpret_cast<const char*>(positions), 8 * numOfNodes);
+		}
+
+		if (!file)
+		{
+			Fail(path, "WRITE FAILED");
+		}
+	}
+}
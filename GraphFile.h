@@ -0,0 +1,113 @@
+#pragma once
+
+#include "SparseMatrix.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Reading and writing graphs on disk. Errors (missing files, malformed contents) throw std::runtime_error
+// with the path and the reason, a file is never partially loaded.
+//
+// Binary format (little-endian), version 1:
+//   Header      64 bytes, see below.
+//   offsets     uint32[numOfNodes + 1]   CSR row offsets, offsets[0] = 0 and offsets[numOfNodes] = numOfEdges.
+//   targets     uint32[numOfEdges]       End node of every edge, sorted and unique within a row.
+//   weights     int32[numOfEdges]        Optional (HAS_WEIGHTS), otherwise every weight is 1.
+//   positions   float[2 * numOfNodes]    Optional (HAS_POSITIONS), x and y of every node.
+// Sections are located through the byte offsets in the header, so readers skip what they do not know.
+namespace GraphFile
+{
+	constexpr char MAGIC[8] = { 'G', 'R', 'A', 'P', 'H', 'E', 'N', 'G' };
+	constexpr std::uint32_t VERSION = 1;
+	constexpr std::uint32_t HAS_WEIGHTS = 1u << 0;
+	constexpr std::uint32_t HAS_POSITIONS = 1u << 1;
+
+	struct Header
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t flags;
+		std::uint64_t numOfNodes;
+		std::uint64_t numOfEdges;
+		std::uint64_t offsetsOffset;		// Byte offsets of the sections from the start of the file, 0 if absent.
+		std::uint64_t targetsOffset;
+		std::uint64_t weightsOffset;
+		std::uint64_t positionsOffset;
+	};
+	static_assert(sizeof(Header) == 64, "The header layout is part of the file format.");
+
+	enum class Format
+	{
+		Auto,				// Binary by its magic, Matrix Market by its banner. Other text files are edge lists if they
+							// have comments (SNAP) or 2 to 3 numbers per line, adjacency matrices otherwise. N lines of N
+							// numbers (N = 2 or 3) are both, Load then throws and the format has to be given.
+		Binary,
+		AdjacencyMatrix,	// See ReadTextMatrix.
+		EdgeList,			// See ReadEdgeList. SNAP files are edge lists.
+		MatrixMarket		// See ReadMatrixMarket.
+	};
+
+	// Read-only memory mapping of a whole file, unmapped on destruction.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const unsigned char* data() const { return m_data; }
+		size_t size() const { return m_size; }
+
+	private:
+		void close();
+
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+	};
+
+	// A loaded graph file. Binary files stay mapped and are used in place, text files are parsed into CSR.
+	class Contents
+	{
+	public:
+		SparseMatrixView getAdjacency() const;
+		// x and y of every node if the file stores a layout, nullptr otherwise.
+		const float* getPositions() const { return m_positions; }
+
+	private:
+		friend Contents Load(const std::string& path, Format format);
+
+		MappedFile m_mapping;
+		Header m_header{};
+		SparseMatrix m_parsed;
+		const float* m_positions = nullptr;
+	};
+
+	Contents Load(const std::string& path, Format format = Format::Auto);
+
+	// Checks the header and the CSR structure of a mapped binary file, O(N + M).
+	Header Validate(const MappedFile& file, const std::string& path);
+
+	// Dense text matrix: whitespace-separated integers, one row per line, zero meaning no edge.
+	// The first row determines N, every other row must have exactly N integers.
+	SparseMatrix ReadTextMatrix(const std::string& path);
+
+	// Text edge list, one edge "from to [weight]" per line, weights default to 1. Lines starting with '#' or '%'
+	// are comments. Node ids can be any non-negative integers, they are remapped to 0 .. N-1 keeping their order.
+	// Large files are parsed in parallel, in chunks of lines.
+	SparseMatrix ReadEdgeList(const std::string& path);
+
+	// Matrix Market coordinate format (integer, real or pattern; general, symmetric or skew-symmetric).
+	// Indices are 1-based and kept as they are. Real values are rounded to integer weights, but never to 0,
+	// since a zero weight means no edge. Large files are parsed in parallel like edge lists.
+	SparseMatrix ReadMatrixMarket(const std::string& path);
+
+	// Rows of adjacency must be sorted by column without duplicates, as in a SparseMatrix.
+	// positions (2 * numOfRows floats) may be nullptr.
+	void Write(const std::string& path, const SparseMatrixView& adjacency, const float* positions = nullptr);
+}
@@ -1,38 +1,204 @@
 #include "GraphGeneration.h"
+#include "Random.h"
+#include "ThreadPool.h"
 
-#include <random>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 namespace GraphGeneration
 {
-	std::vector<std::vector<int>> GenerateRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength)
+	namespace
 	{
-		std::random_device rd;
-		std::mt19937 rngEngine(rd());
-		std::uniform_real_distribution<> realDist(0, 1);
+		// Every block of rows draws from its own stream, so block boundaries must not depend on the thread count.
+		constexpr unsigned int ROWS_PER_BLOCK = 1024;
 
-		// std::vector of size numOfNodes, where each element is another std::vector<int> of size numOfNodes, initialized to 0.
-		std::vector<std::vector<int>> adjacencyMatrix(numOfNodes, std::vector<int>(numOfNodes, 0));
+		constexpr unsigned int NODES_PER_BLOCK = 4096;
+		constexpr unsigned long long EDGES_PER_BLOCK = 1 << 16;
+
+		int RandomWeight(Philox& rng, int maxStrength)
+		{
+			return 1 + static_cast<int>(rng.nextBelow(static_cast<std::uint32_t>(std::max(maxStrength, 1))));
+		}
 
-		for (size_t i = 0; i < numOfNodes; ++i)
+		// Visits the edges of a numOfRows x numOfColumns block of the adjacency matrix, each present with probability p,
+		// in row-major order. Instead of testing every pair, it jumps straight to the next edge: the number of pairs
+		// skipped before it is geometrically distributed (Batagelj-Brandes), so the cost is O(rows + edges).
+		// If withoutDiagonal, row i cannot link to column diagonalStart + i (a self-loop): its other columns are
+		// numbered 0 .. numOfColumns - 2, c standing for c if c < diagonalStart + i and c + 1 otherwise.
+		template<typename Visit>
+		void SkipSample(Philox& rng, unsigned int numOfRows, unsigned int numOfColumns, double p, bool withoutDiagonal, unsigned int diagonalStart, const Visit& visit)
 		{
-			for (size_t j = 0; j < numOfNodes; ++j)
+			const unsigned long long numOfCandidates = withoutDiagonal ? numOfColumns - 1ull : numOfColumns;
+			const unsigned long long numOfPairs = numOfRows * numOfCandidates;
+			if (p <= 0.0 || numOfPairs == 0)
 			{
-				if (i != j)
+				return;
+			}
+			const double logOfMiss = std::log1p(-p);
+
+			unsigned long long pair = 0;
+			while (true)
+			{
+				if (p < 1.0)
 				{
-					float existenceDeterminer = realDist(rngEngine);
-					if (existenceDeterminer < connectionProbability)
+					// 1 - r is in (0, 1], so the logarithm is finite.
+					double skip = std::floor(std::log(1.0 - rng.nextDouble()) / logOfMiss);
+					if (skip >= double(numOfPairs - pair))
 					{
-						float weightDeterminer = realDist(rngEngine);
-						adjacencyMatrix[i][j] = int(realDist(rngEngine) * float(maxStrength) + 1.0f);
+						break;
 					}
+					pair += static_cast<unsigned long long>(skip);
 				}
+				if (pair >= numOfPairs)
+				{
+					break;
+				}
+
+				const unsigned int i = static_cast<unsigned int>(pair / numOfCandidates);
+				const unsigned int c = static_cast<unsigned int>(pair % numOfCandidates);
+				visit(i, withoutDiagonal && c >= diagonalStart + i ? c + 1 : c);
+				pair++;
 			}
 		}
 
-		return adjacencyMatrix;
+		// Generates fixed blocks of edges in parallel and hands them to the sink in block order. Only one round of
+		// blocks is buffered. generateBlock(block, edges) appends the edges of a block.
+		template<typename GenerateBlock>
+		void StreamBlocks(size_t numOfBlocks, const GenerateBlock& generateBlock, const EdgeSink& sink)
+		{
+			ThreadPool& pool = ThreadPool::getGlobal();
+			const size_t blocksPerRound = 4 * static_cast<size_t>(pool.getNumOfThreads());
+			std::vector<std::vector<SparseEntry>> buffers(std::min(blocksPerRound, numOfBlocks));
+
+			for (size_t first = 0; first < numOfBlocks; first += blocksPerRound)
+			{
+				const size_t last = std::min(first + blocksPerRound, numOfBlocks);
+				pool.parallelFor(first, last, [&](size_t begin, size_t end, unsigned int)
+					{
+						for (size_t b = begin; b < end; ++b)
+						{
+							buffers[b - first].clear();
+							generateBlock(b, buffers[b - first]);
+						}
+					}, 1);
+
+				for (size_t b = first; b < last; ++b)
+				{
+					if (!buffers[b - first].empty())
+					{
+						sink(buffers[b - first].data(), buffers[b - first].size());
+					}
+				}
+			}
+		}
+
+		SparseMatrix CollectEdges(unsigned int numOfNodes, const std::function<void(const EdgeSink&)>& generate)
+		{
+			std::vector<SparseEntry> entries;
+			generate([&](const SparseEntry* edges, size_t count)
+				{
+					entries.insert(entries.end(), edges, edges + count);
+				});
+			return SparseMatrix::fromEntries(numOfNodes, std::move(entries));
+		}
 	}
 
-	std::vector<std::vector<int>> GenerateWattsStrogatzModel(unsigned int numOfNodes, unsigned int meanDegree, float rewireProbability, int maxStrength)
+	SparseMatrix GenerateSparseRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength, std::uint64_t seed)
+	{
+		SparseMatrix adjacency;
+		adjacency.numOfRows = numOfNodes;
+		adjacency.offsets.assign(numOfNodes + 1, 0);
+		if (numOfNodes < 2 || connectionProbability <= 0.0f)
+		{
+			return adjacency;
+		}
+
+		// Blocks of rows are sampled independently, each with its own stream.
+		const double p = std::min(double(connectionProbability), 1.0);
+		const size_t numOfBlocks = (numOfNodes + ROWS_PER_BLOCK - 1) / ROWS_PER_BLOCK;
+
+		struct Block
+		{
+			std::vector<unsigned int> columns;
+			std::vector<int> values;
+			std::vector<unsigned int> rowEnds;	// Relative to the block.
+		};
+		std::vector<Block> blocks(numOfBlocks);
+
+		ThreadPool::getGlobal().parallelFor(0, numOfBlocks, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t b = begin; b < end; ++b)
+				{
+					Block& block = blocks[b];
+					Philox rng{ seed, b };
+					const unsigned int firstRow = static_cast<unsigned int>(b * ROWS_PER_BLOCK);
+					const unsigned int numOfRows = std::min(ROWS_PER_BLOCK, numOfNodes - firstRow);
+					const double expectedEdges = p * double(numOfRows) * double(numOfNodes - 1);
+					block.columns.reserve(static_cast<size_t>(expectedEdges + 4.0 * std::sqrt(expectedEdges)));
+					block.values.reserve(block.columns.capacity());
+					block.rowEnds.assign(numOfRows, 0);
+
+					// Rows are produced in order, so the offsets can be filled as we go.
+					unsigned int row = 0;
+					SkipSample(rng, numOfRows, numOfNodes, p, true, firstRow, [&](unsigned int i, unsigned int column)
+						{
+							while (row < i)
+							{
+								block.rowEnds[row++] = static_cast<unsigned int>(block.columns.size());
+							}
+							block.columns.push_back(column);
+							block.values.push_back(RandomWeight(rng, maxStrength));
+						});
+					while (row < numOfRows)
+					{
+						block.rowEnds[row++] = static_cast<unsigned int>(block.columns.size());
+					}
+				}
+			}, 1);
+
+		// Stitch the blocks together in order.
+		std::vector<size_t> blockBegins(numOfBlocks + 1, 0);
+		for (size_t b = 0; b < numOfBlocks; ++b)
+		{
+			blockBegins[b + 1] = blockBegins[b] + blocks[b].columns.size();
+		}
+		adjacency.columns.resize(blockBegins.back());
+		adjacency.values.resize(blockBegins.back());
+		ThreadPool::getGlobal().parallelFor(0, numOfBlocks, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t b = begin; b < end; ++b)
+				{
+					Block& block = blocks[b];
+					std::copy(block.columns.begin(), block.columns.end(), adjacency.columns.begin() + blockBegins[b]);
+					std::copy(block.values.begin(), block.values.end(), adjacency.values.begin() + blockBegins[b]);
+					for (size_t row = 0; row < block.rowEnds.size(); ++row)
+					{
+						adjacency.offsets[b * ROWS_PER_BLOCK + row + 1] = static_cast<unsigned int>(blockBegins[b] + block.rowEnds[row]);
+					}
+					block = Block{};
+				}
+			}, 1);
+
+		return adjacency;
+	}
+
+	SparseMatrix GenerateSparseRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength)
+	{
+		return GenerateSparseRandomGraph(numOfNodes, connectionProbability, maxStrength, Philox::RandomSeed());
+	}
+
+	std::vector<std::vector<int>> GenerateRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength, std::uint64_t seed)
+	{
+		return GenerateSparseRandomGraph(numOfNodes, connectionProbability, maxStrength, seed).toDense();
+	}
+
+	std::vector<std::vector<int>> GenerateRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength)
+	{
+		return GenerateRandomGraph(numOfNodes, connectionProbability, maxStrength, Philox::RandomSeed());
+	}
+
+	std::vector<std::vector<int>> GenerateWattsStrogatzModel(unsigned int numOfNodes, unsigned int meanDegree, float rewireProbability, int maxStrength, std::uint64_t seed)
 	{
 		if (meanDegree >= numOfNodes)
 			throw std::invalid_argument("Mean Degree must be smaller than number of the nodes!");
@@ -40,11 +206,7 @@ namespace GraphGeneration
 		if (meanDegree % 2 != 0)
 			throw std::invalid_argument("Mean Degree must be even!");
 
-		std::random_device rd;
-		std::mt19937 rngEngine(rd());
-		std::uniform_real_distribution<> realDist(0, 1);
-		std::uniform_int_distribution<> nodeDist(0, numOfNodes - 1);
-		std::uniform_int_distribution<> weightDist(1, maxStrength);
+		Philox rng{ seed };
 
 		std::vector<std::vector<int>> adjacencyMatrix(numOfNodes, std::vector<int>(numOfNodes, 0));
 
@@ -53,7 +215,7 @@ namespace GraphGeneration
 			for (unsigned int j = 1; j <= meanDegree / 2; j++)
 			{
 				unsigned int neighbor = (i + j) % numOfNodes;
-				int weight = weightDist(rngEngine);
+				int weight = RandomWeight(rng, maxStrength);
 				adjacencyMatrix[i][neighbor] = weight;
 				adjacencyMatrix[neighbor][i] = weight;
 			}
@@ -65,19 +227,19 @@ namespace GraphGeneration
 			{
 				unsigned int neighbor = (i + j) % numOfNodes;
 
-				if (realDist(rngEngine) < rewireProbability)
+				if (rng.nextDouble() < rewireProbability)
 				{
 					unsigned int newNeighbor;
 
 					do
 					{
-						newNeighbor = nodeDist(rngEngine);
+						newNeighbor = rng.nextBelow(numOfNodes);
 					} while (newNeighbor == i || adjacencyMatrix[i][newNeighbor] != 0);
 
 					adjacencyMatrix[i][neighbor] = 0;
 					adjacencyMatrix[neighbor][i] = 0;
 
-					int weight = weightDist(rngEngine);
+					int weight = RandomWeight(rng, maxStrength);
 					adjacencyMatrix[i][newNeighbor] = weight;
 					adjacencyMatrix[newNeighbor][i] = weight;
 
@@ -88,4 +250,195 @@ namespace GraphGeneration
 
 		return adjacencyMatrix;
 	}
-}
\ No newline at end of file
+
+	std::vector<std::vector<int>> GenerateWattsStrogatzModel(unsigned int numOfNodes, unsigned int meanDegree, float rewireProbability, int maxStrength)
+	{
+		return GenerateWattsStrogatzModel(numOfNodes, meanDegree, rewireProbability, maxStrength, Philox::RandomSeed());
+	}
+
+	void GenerateBarabasiAlbert(unsigned int numOfNodes, unsigned int edgesPerNode, int maxStrength, std::uint64_t seed, const EdgeSink& sink)
+	{
+		if (edgesPerNode == 0 || edgesPerNode >= numOfNodes)
+			throw std::invalid_argument("Edges per node must be positive and smaller than number of the nodes!");
+
+		// Edge e = v * m + i is the i-th edge of node v. In the endpoint array, slot 2e holds its source v and slot
+		// 2e + 1 its target. Node 0 owns m virtual self-loops (not emitted) so the first real nodes have something
+		// to attach to, nodes 1 .. m link to all earlier nodes.
+		const unsigned long long m = edgesPerNode;
+		constexpr std::uint64_t TARGET_STREAM = ~0ull;	// Reserved, the weight streams are numbered by block.
+		auto resolveTarget = [&](unsigned long long edge)
+			{
+				while (true)
+				{
+					const unsigned long long v = edge / m;
+					if (v == 0)
+					{
+						return 0u;
+					}
+					if (v <= m)
+					{
+						return static_cast<unsigned int>((edge % m) % v);
+					}
+					// Copy a uniformly chosen slot of an earlier node: a source slot is that node, a target slot
+					// has to be resolved in turn. The chain is short, every step goes back to a random earlier edge.
+					const unsigned long long slot = Philox::Hash(seed, TARGET_STREAM, edge) % (2 * m * v);
+					if (slot % 2 == 0)
+					{
+						return static_cast<unsigned int>(slot / 2 / m);
+					}
+					edge = slot / 2;
+				}
+			};
+
+		const size_t numOfBlocks = (numOfNodes + NODES_PER_BLOCK - 1) / NODES_PER_BLOCK;
+		StreamBlocks(numOfBlocks, [&](size_t block, std::vector<SparseEntry>& edges)
+			{
+				Philox rng{ seed, block };
+				const unsigned int firstNode = static_cast<unsigned int>(block * NODES_PER_BLOCK);
+				const unsigned int lastNode = std::min(firstNode + NODES_PER_BLOCK, numOfNodes);
+				std::vector<unsigned int> targets(edgesPerNode);
+				for (unsigned int v = std::max(firstNode, 1u); v < lastNode; ++v)
+				{
+					for (unsigned int i = 0; i < edgesPerNode; ++i)
+					{
+						targets[i] = resolveTarget(v * m + i);
+					}
+					std::sort(targets.begin(), targets.end());
+					auto uniqueEnd = std::unique(targets.begin(), targets.end());
+					for (auto it = targets.begin(); it != uniqueEnd; ++it)
+					{
+						edges.push_back({ v, *it, RandomWeight(rng, maxStrength) });
+					}
+				}
+			}, sink);
+	}
+
+	SparseMatrix GenerateBarabasiAlbert(unsigned int numOfNodes, unsigned int edgesPerNode, int maxStrength, std::uint64_t seed)
+	{
+		return CollectEdges(numOfNodes, [&](const EdgeSink& sink)
+			{
+				GenerateBarabasiAlbert(numOfNodes, edgesPerNode, maxStrength, seed, sink);
+			});
+	}
+
+	void GenerateRMAT(unsigned int scale, unsigned long long numOfEdges, float a, float b, float c, int maxStrength, std::uint64_t seed, const EdgeSink& sink)
+	{
+		if (scale == 0 || scale > 31)
+			throw std::invalid_argument("Scale must be between 1 and 31!");
+
+		if (a < 0.0f || b < 0.0f || c < 0.0f || a + b + c > 1.0f)
+			throw std::invalid_argument("Quadrant probabilities must be non-negative and sum to at most 1!");
+
+		// Every level descends into a quadrant with one 16-bit draw, two levels per random word. The quadrant
+		// probabilities are rounded to multiples of 2^-16, which is far below the noise of the model.
+		auto threshold = [](double probability)
+			{
+				return static_cast<std::uint32_t>(std::lround(std::min(probability, 1.0) * 65536.0));
+			};
+		const std::uint32_t thresholdA = threshold(a);
+		const std::uint32_t thresholdAB = threshold(double(a) + double(b));
+		const std::uint32_t thresholdABC = threshold(double(a) + double(b) + double(c));
+
+		const size_t numOfBlocks = static_cast<size_t>((numOfEdges + EDGES_PER_BLOCK - 1) / EDGES_PER_BLOCK);
+		StreamBlocks(numOfBlocks, [&](size_t block, std::vector<SparseEntry>& edges)
+			{
+				Philox rng{ seed, block };
+				const unsigned long long firstEdge = block * EDGES_PER_BLOCK;
+				const unsigned long long lastEdge = std::min(firstEdge + EDGES_PER_BLOCK, numOfEdges);
+				edges.reserve(static_cast<size_t>(lastEdge - firstEdge));
+				for (unsigned long long e = firstEdge; e < lastEdge; ++e)
+				{
+					unsigned int row = 0;
+					unsigned int column = 0;
+					std::uint32_t bits = 0;
+					for (unsigned int level = 0; level < scale; ++level)
+					{
+						if (level % 2 == 0)
+						{
+							bits = rng.nextUInt();
+						}
+						const std::uint32_t r = (level % 2 == 0 ? bits : bits >> 16) & 0xFFFF;
+						row = (row << 1) | (r >= thresholdAB ? 1u : 0u);
+						column = (column << 1) | ((r >= thresholdA && r < thresholdAB) || r >= thresholdABC ? 1u : 0u);
+					}
+					edges.push_back({ row, column, RandomWeight(rng, maxStrength) });
+				}
+			}, sink);
+	}
+
+	SparseMatrix GenerateRMAT(unsigned int scale, unsigned long long numOfEdges, float a, float b, float c, int maxStrength, std::uint64_t seed)
+	{
+		return CollectEdges(1u << scale, [&](const EdgeSink& sink)
+			{
+				GenerateRMAT(scale, numOfEdges, a, b, c, maxStrength, seed, sink);
+			});
+	}
+
+	void GenerateStochasticBlockModel(const std::vector<unsigned int>& communitySizes, const std::vector<std::vector<float>>& probabilities,
+		int maxStrength, std::uint64_t seed, const EdgeSink& sink)
+	{
+		const size_t numOfCommunities = communitySizes.size();
+		if (probabilities.size() != numOfCommunities)
+			throw std::invalid_argument("Probabilities must be a square matrix with one row per community!");
+
+		for (const std::vector<float>& row : probabilities)
+		{
+			if (row.size() != numOfCommunities)
+				throw std::invalid_argument("Probabilities must be a square matrix with one row per community!");
+		}
+
+		// Blocks of at most ROWS_PER_BLOCK rows that never straddle two communities.
+		std::vector<unsigned int> communityBegins(numOfCommunities + 1, 0);
+		struct RowBlock
+		{
+			unsigned int community;
+			unsigned int firstRow;
+			unsigned int numOfRows;
+		};
+		std::vector<RowBlock> rowBlocks;
+		for (size_t k = 0; k < numOfCommunities; ++k)
+		{
+			communityBegins[k + 1] = communityBegins[k] + communitySizes[k];
+			for (unsigned int row = 0; row < communitySizes[k]; row += ROWS_PER_BLOCK)
+			{
+				rowBlocks.push_back({ static_cast<unsigned int>(k), communityBegins[k] + row, std::min(ROWS_PER_BLOCK, communitySizes[k] - row) });
+			}
+		}
+
+		StreamBlocks(rowBlocks.size(), [&](size_t block, std::vector<SparseEntry>& edges)
+			{
+				Philox rng{ seed, block };
+				const RowBlock& rows = rowBlocks[block];
+				for (size_t l = 0; l < numOfCommunities; ++l)
+				{
+					const double p = std::min(double(probabilities[rows.community][l]), 1.0);
+					const bool sameCommunity = l == rows.community;
+					const unsigned int diagonalStart = rows.firstRow - communityBegins[l];
+					SkipSample(rng, rows.numOfRows, communitySizes[l], p, sameCommunity, diagonalStart, [&](unsigned int i, unsigned int column)
+						{
+							edges.push_back({ rows.firstRow + i, communityBegins[l] + column, RandomWeight(rng, maxStrength) });
+						});
+				}
+
+				// Community by community, the rows interleave. Sort them back into row order.
+				std::sort(edges.begin(), edges.end(), [](const SparseEntry& x, const SparseEntry& y)
+					{
+						return x.row != y.row ? x.row < y.row : x.column < y.column;
+					});
+			}, sink);
+	}
+
+	SparseMatrix GenerateStochasticBlockModel(const std::vector<unsigned int>& communitySizes, const std::vector<std::vector<float>>& probabilities,
+		int maxStrength, std::uint64_t seed)
+	{
+		unsigned int numOfNodes = 0;
+		for (unsigned int size : communitySizes)
+		{
+			numOfNodes += size;
+		}
+		return CollectEdges(numOfNodes, [&](const EdgeSink& sink)
+			{
+				GenerateStochasticBlockModel(communitySizes, probabilities, maxStrength, seed, sink);
+			});
+	}
+}
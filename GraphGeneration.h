@@ -1,10 +1,53 @@
 #pragma once 
 
+#include "SparseMatrix.h"
+
+#include <cstdint>
+#include <functional>
 #include <vector>
 
+// The generators taking a seed are reproducible: the same seed gives the same graph on every run, platform and
+// number of threads (they draw from counter-based streams, see Random.h). The overloads without one pick a random seed.
 namespace GraphGeneration
 {
+	// Receives generated edges (row = source, column = target, value = weight) in chunks, always in the same order
+	// for a given seed. Only the current chunks are held in memory, so graphs larger than RAM can be streamed to disk.
+	// Called on the calling thread.
+	using EdgeSink = std::function<void(const SparseEntry* edges, size_t count)>;
+
+	// Directed Erdos-Renyi graph G(N, p) without self-loops, weights uniform in [1, maxStrength].
+	// Uses geometric skip sampling (Batagelj-Brandes), so it costs O(N + M) rather than O(N^2).
+	// Blocks of rows are generated in parallel.
+	extern SparseMatrix GenerateSparseRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength, std::uint64_t seed);
+	extern SparseMatrix GenerateSparseRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength);
+	// Same graph as a dense matrix. O(N^2) memory, prefer the sparse version for large N.
+	extern std::vector<std::vector<int>> GenerateRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength, std::uint64_t seed);
 	extern std::vector<std::vector<int>> GenerateRandomGraph(unsigned int numOfNodes, float connectionProbability, int maxStrength);
+	// Rewiring depends on the edges rewired before, so this one runs on a single thread.
+	extern std::vector<std::vector<int>> GenerateWattsStrogatzModel(unsigned int numOfNodes, unsigned int meanDegree, float rewireProbability, int maxStrength, std::uint64_t seed);
 	extern std::vector<std::vector<int>> GenerateWattsStrogatzModel(unsigned int numOfNodes, unsigned int meanDegree, float rewireProbability, int maxStrength);
 
-}
\ No newline at end of file
+	// Barabasi-Albert preferential attachment: every node after the first edgesPerNode + 1 links to edgesPerNode
+	// earlier nodes, chosen with probability proportional to their degree (edges point from new to old nodes).
+	// Targets are sampled from the implicit array of edge endpoints: a target slot copies a uniformly chosen earlier
+	// slot, resolved by hashing instead of storing the array (Sanders and Schulz), so nodes are generated in
+	// parallel in O(1) extra memory. A node that draws the same target twice keeps it once.
+	extern void GenerateBarabasiAlbert(unsigned int numOfNodes, unsigned int edgesPerNode, int maxStrength, std::uint64_t seed, const EdgeSink& sink);
+	extern SparseMatrix GenerateBarabasiAlbert(unsigned int numOfNodes, unsigned int edgesPerNode, int maxStrength, std::uint64_t seed);
+
+	// R-MAT (recursive matrix, a stochastic Kronecker graph) with 2^scale nodes. Every edge descends scale levels
+	// of the adjacency matrix, picking the top left, top right, bottom left or bottom right quadrant with
+	// probabilities a, b, c and 1 - a - b - c. The streamed edges may contain duplicates and self-loops,
+	// the SparseMatrix keeps one of each duplicate (and Graph skips self-loops).
+	extern void GenerateRMAT(unsigned int scale, unsigned long long numOfEdges, float a, float b, float c, int maxStrength, std::uint64_t seed, const EdgeSink& sink);
+	extern SparseMatrix GenerateRMAT(unsigned int scale, unsigned long long numOfEdges, float a, float b, float c, int maxStrength, std::uint64_t seed);
+
+	// Directed stochastic block model: nodes are split into consecutive communities of the given sizes and an edge
+	// from a node of community k to a node of community l exists with probability probabilities[k][l].
+	// Each community pair is sampled by skipping like GenerateSparseRandomGraph, so the cost is O(N + M).
+	// Edges are streamed sorted by source, then target.
+	extern void GenerateStochasticBlockModel(const std::vector<unsigned int>& communitySizes, const std::vector<std::vector<float>>& probabilities,
+		int maxStrength, std::uint64_t seed, const EdgeSink& sink);
+	extern SparseMatrix GenerateStochasticBlockModel(const std::vector<unsigned int>& communitySizes, const std::vector<std::vector<float>>& probabilities,
+		int maxStrength, std::uint64_t seed);
+}
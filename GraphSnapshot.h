@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ViewCuller.h"
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Copy of everything needed to draw a Graph. The simulation thread fills one with Graph::takeSnapshot
+// and the render thread draws it, so drawing never reads the graph while it is being updated.
+struct GraphSnapshot : public sf::Drawable
+{
+	sf::Transform transform;
+	sf::VertexArray nodeVertices;
+	sf::VertexArray edgeVertices;
+	std::vector<ViewCuller::Bounds> nodeBounds;
+	std::vector<ViewCuller::Bounds> edgeBounds;
+
+	// Weight labels, world position of the text and the weight of every edge.
+	std::vector<sf::Vector2f> edgeLabelPositions;
+	std::vector<int> edgeWeights;
+
+private:
+	mutable ViewCuller culler;
+
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override
+	{
+		states.transform *= transform;
+		culler.draw(target, states, nodeVertices, nodeBounds, edgeVertices, edgeBounds);
+	}
+};
@@ -4,7 +4,7 @@
 
 namespace Input
 {
-    void HandleInputs(sf::RenderWindow& window, InputState& inputState, sf::View& view, Graph& graph)
+    void HandleInputs(sf::RenderWindow& window, InputState& inputState, sf::View& view)
     {
         while (const auto event = window.pollEvent())
         {
@@ -42,7 +42,8 @@ namespace Input
                     // Select closest node once.
                     if (!inputState.mouseRightPressed)
                     {
-                        inputState.selectedNodeIndexForInfo = graph.findClosestNode(window.mapPixelToCoords(mouseButtonPressed->position));
+                        inputState.infoPickRequested = true;
+                        inputState.infoPickPosition = window.mapPixelToCoords(mouseButtonPressed->position);
                     }
                     inputState.mouseLeftPressed = true;
                 }
@@ -51,7 +52,8 @@ namespace Input
                     // Select closest node once.
                     if (!inputState.mouseRightPressed)
                     {
-                        inputState.selectedNodeIndexForMoving = graph.findClosestNode(window.mapPixelToCoords(mouseButtonPressed->position));
+                        inputState.movePickRequested = true;
+                        inputState.movePickPosition = window.mapPixelToCoords(mouseButtonPressed->position);
                     }
                     inputState.mouseRightPressed = true;
                 }
@@ -18,11 +18,16 @@ namespace Input
         bool mouseLeftPressed = false;
         bool mouseRightPressed = false;
         bool keyPressed_P = false;
+        // Clicks waiting to be resolved to the closest node. The simulation resolves them against the graph.
+        bool infoPickRequested = false;
+        bool movePickRequested = false;
+        sf::Vector2f infoPickPosition;
+        sf::Vector2f movePickPosition;
         sf::Vector2i lastMousePos;
         sf::Vector2f lastMouseWorldPos;
         InputDeltas deltas;
     };
 
-    void HandleInputs(sf::RenderWindow& window, InputState& inputState, sf::View& view, Graph& graph);
+    void HandleInputs(sf::RenderWindow& window, InputState& inputState, sf::View& view);
     void ResetDeltas(InputState& inputState);
 }
\ No newline at end of file
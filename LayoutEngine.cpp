@@ -0,0 +1,136 @@
+#include "LayoutEngine.h"
+#include "LayoutKernels.h"
+
+LayoutEngine::LayoutEngine(ThreadPool& pool)
+	: m_pool{ pool },
+	  m_interactions(pool.getNumOfThreads())
+{
+}
+
+void LayoutEngine::step(std::vector<Node>& nodes, const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency,
+	int nodeHeld, sf::Vector2f inject)
+{
+	const size_t numOfNodes = nodes.size();
+	m_x.resize(numOfNodes);
+	m_y.resize(numOfNodes);
+	m_forceX.resize(numOfNodes);
+	m_forceY.resize(numOfNodes);
+
+	for (size_t i = 0; i < numOfNodes; ++i)
+	{
+		m_x[i] = nodes[i].position.x;
+		m_y[i] = nodes[i].position.y;
+	}
+
+	if (m_topologyChanged || m_springOffsets.size() != numOfNodes + 1)
+	{
+		buildSpringNeighbors(outAdjacency, inAdjacency);
+		m_topologyChanged = false;
+	}
+
+	if (!m_exactRepulsion)
+	{
+		m_quadTree.build(m_x, m_y);
+	}
+
+	// Springs, F = k * r * r_hat = k * dr, summed over neighbors: k * (sum(r_j) - degree * r_i).
+	auto addSpringForce = [&](size_t i, float& fx, float& fy)
+		{
+			const unsigned int springBegin = m_springOffsets[i];
+			const unsigned int degree = m_springOffsets[i + 1] - springBegin;
+			float sumX, sumY;
+			LayoutKernels::SumNeighborPositions(m_x.data(), m_y.data(), m_springNeighbors.data() + springBegin, degree, sumX, sumY);
+			fx += m_attraction * (sumX - static_cast<float>(degree) * m_x[i]);
+			fy += m_attraction * (sumY - static_cast<float>(degree) * m_y[i]);
+		};
+
+	// Repulsion, F = -(k/r) * r_hat from every other node (the node itself contributes zero).
+	if (m_exactRepulsion)
+	{
+		m_pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					float fx = 0.0f;
+					float fy = 0.0f;
+					LayoutKernels::AccumulateRepulsion(m_x[i], m_y[i], m_x.data(), m_y.data(), nullptr, numOfNodes, m_repulsion, fx, fy);
+					addSpringForce(i, fx, fy);
+					m_forceX[i] = fx;
+					m_forceY[i] = fy;
+				}
+			}, 64);
+	}
+	else
+	{
+		// Barnes-Hut, owned by leaf: the nodes of a leaf share one interaction list.
+		m_pool.parallelFor(0, m_quadTree.getNumOfLeaves(), [&](size_t begin, size_t end, unsigned int threadIndex)
+			{
+				QuadTree::InteractionList& interactions = m_interactions[threadIndex];
+				for (size_t leaf = begin; leaf < end; ++leaf)
+				{
+					interactions.clear();
+					m_quadTree.collectInteractions(leaf, m_theta, interactions);
+
+					const unsigned int* leafNodes = m_quadTree.getLeafNodes(leaf);
+					for (unsigned int k = 0; k < m_quadTree.getLeafSize(leaf); ++k)
+					{
+						const size_t i = leafNodes[k];
+						float fx = 0.0f;
+						float fy = 0.0f;
+						LayoutKernels::AccumulateRepulsion(m_x[i], m_y[i], interactions.x.data(), interactions.y.data(), interactions.mass.data(),
+							interactions.x.size(), m_repulsion, fx, fy);
+						addSpringForce(i, fx, fy);
+						m_forceX[i] = fx;
+						m_forceY[i] = fy;
+					}
+				}
+			}, 16);
+	}
+
+	// Single write back into the nodes.
+	for (size_t i = 0; i < numOfNodes; ++i)
+	{
+		if (nodeHeld == static_cast<int>(i))
+		{
+			nodes[i].position = inject;
+		}
+		else
+		{
+			nodes[i].position = { m_x[i] + m_forceX[i], m_y[i] + m_forceY[i] };
+		}
+	}
+}
+
+void LayoutEngine::buildSpringNeighbors(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency)
+{
+	const size_t numOfNodes = outAdjacency.offsets.size() - 1;
+	m_springOffsets.assign(numOfNodes + 1, 0);
+	m_springNeighbors.clear();
+	m_springNeighbors.reserve(outAdjacency.neighbors.size() + inAdjacency.neighbors.size());
+
+	// Both rows are sorted, so they are merged and duplicates are skipped.
+	for (size_t i = 0; i < numOfNodes; ++i)
+	{
+		unsigned int outK = outAdjacency.offsets[i];
+		unsigned int outEnd = outAdjacency.offsets[i + 1];
+		unsigned int inK = inAdjacency.offsets[i];
+		unsigned int inEnd = inAdjacency.offsets[i + 1];
+		while (outK < outEnd || inK < inEnd)
+		{
+			if (inK == inEnd || (outK < outEnd && outAdjacency.neighbors[outK] < inAdjacency.neighbors[inK]))
+			{
+				m_springNeighbors.push_back(outAdjacency.neighbors[outK++]);
+			}
+			else if (outK == outEnd || inAdjacency.neighbors[inK] < outAdjacency.neighbors[outK])
+			{
+				m_springNeighbors.push_back(inAdjacency.neighbors[inK++]);
+			}
+			else
+			{
+				m_springNeighbors.push_back(outAdjacency.neighbors[outK++]);
+				inK++;
+			}
+		}
+		m_springOffsets[i + 1] = static_cast<unsigned int>(m_springNeighbors.size());
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Settings.h"
+#include "NodeAndEdge.h"
+#include "SparseMatrix.h"
+#include "QuadTree.h"
+#include "ThreadPool.h"
+#include <vector>
+
+// Force-directed layout: ~1/r repulsion between all nodes and Hooke springs along edges.
+// Positions and forces are kept as separate contiguous x/y arrays (structure of arrays) and the inner
+// loops run in the SIMD kernels of LayoutKernels. Node::position is read once and written once per step.
+// Forces are computed owner-computes style: every node sums the forces acting on itself in a fixed order,
+// so nodes can be split across threads without races and the result does not depend on the thread count.
+class LayoutEngine
+{
+public:
+	explicit LayoutEngine(ThreadPool& pool = ThreadPool::getGlobal());
+
+	// Moves every node by the net force acting on it. The held node is placed at inject instead.
+	void step(std::vector<Node>& nodes, const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency,
+		int nodeHeld = -1, sf::Vector2f inject = { 0, 0 });
+
+	// Call when edges were added or removed, the spring neighbor lists are then rebuilt on the next step.
+	void setTopologyChanged() { m_topologyChanged = true; }
+
+	void setExactRepulsion(bool exact) { m_exactRepulsion = exact; }
+	void setBarnesHutTheta(float theta) { m_theta = theta; }
+	ThreadPool& getThreadPool() { return m_pool; }
+
+private:
+	void buildSpringNeighbors(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency);
+
+	ThreadPool& m_pool;
+	QuadTree m_quadTree;
+	std::vector<QuadTree::InteractionList> m_interactions;	// One per thread.
+
+	// Reused between steps.
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	std::vector<float> m_forceX;
+	std::vector<float> m_forceY;
+
+	// Undirected neighbors, an edge pair going both ways is a single spring.
+	std::vector<unsigned int> m_springOffsets;
+	std::vector<unsigned int> m_springNeighbors;
+	bool m_topologyChanged = true;
+
+	float m_attraction = Settings::ATTRACTION_FORCE;
+	float m_repulsion = Settings::REPULSION_FORCE;
+	bool m_exactRepulsion = Settings::EXACT_REPULSION;
+	float m_theta = Settings::BARNES_HUT_THETA;
+};
@@ -0,0 +1,188 @@
+#include "LayoutKernels.h"
+
+#if defined(__AVX2__)
+	#define LAYOUT_KERNELS_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define LAYOUT_KERNELS_SSE2
+	#include <emmintrin.h>
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+	#define LAYOUT_KERNELS_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace LayoutKernels
+{
+	// r = max(r, 1e-2) in the original formulation, squared.
+	constexpr float MIN_DISTANCE_SQUARED = 1e-4f;
+
+	void AccumulateRepulsion(float px, float py, const float* xs, const float* ys, const float* masses, size_t count,
+		float repulsion, float& fx, float& fy)
+	{
+		float sumX = 0.0f;
+		float sumY = 0.0f;
+		size_t i = 0;
+
+#if defined(LAYOUT_KERNELS_AVX2)
+		const __m256 vpx = _mm256_set1_ps(px);
+		const __m256 vpy = _mm256_set1_ps(py);
+		const __m256 vmin = _mm256_set1_ps(MIN_DISTANCE_SQUARED);
+		const __m256 vone = _mm256_set1_ps(1.0f);
+		__m256 accX = _mm256_setzero_ps();
+		__m256 accY = _mm256_setzero_ps();
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vpx);
+			__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vpy);
+			__m256 d2 = _mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), vmin);
+			__m256 mass = masses ? _mm256_loadu_ps(masses + i) : vone;
+			__m256 scale = _mm256_div_ps(mass, d2);
+			accX = _mm256_add_ps(accX, _mm256_mul_ps(dx, scale));
+			accY = _mm256_add_ps(accY, _mm256_mul_ps(dy, scale));
+		}
+		alignas(32) float lanesX[8];
+		alignas(32) float lanesY[8];
+		_mm256_store_ps(lanesX, accX);
+		_mm256_store_ps(lanesY, accY);
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			sumX += lanesX[lane];
+			sumY += lanesY[lane];
+		}
+#elif defined(LAYOUT_KERNELS_SSE2)
+		const __m128 vpx = _mm_set1_ps(px);
+		const __m128 vpy = _mm_set1_ps(py);
+		const __m128 vmin = _mm_set1_ps(MIN_DISTANCE_SQUARED);
+		const __m128 vone = _mm_set1_ps(1.0f);
+		__m128 accX = _mm_setzero_ps();
+		__m128 accY = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vpx);
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), vpy);
+			__m128 d2 = _mm_max_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), vmin);
+			__m128 mass = masses ? _mm_loadu_ps(masses + i) : vone;
+			__m128 scale = _mm_div_ps(mass, d2);
+			accX = _mm_add_ps(accX, _mm_mul_ps(dx, scale));
+			accY = _mm_add_ps(accY, _mm_mul_ps(dy, scale));
+		}
+		alignas(16) float lanesX[4];
+		alignas(16) float lanesY[4];
+		_mm_store_ps(lanesX, accX);
+		_mm_store_ps(lanesY, accY);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			sumX += lanesX[lane];
+			sumY += lanesY[lane];
+		}
+#elif defined(LAYOUT_KERNELS_NEON)
+		const float32x4_t vpx = vdupq_n_f32(px);
+		const float32x4_t vpy = vdupq_n_f32(py);
+		const float32x4_t vmin = vdupq_n_f32(MIN_DISTANCE_SQUARED);
+		const float32x4_t vone = vdupq_n_f32(1.0f);
+		float32x4_t accX = vdupq_n_f32(0.0f);
+		float32x4_t accY = vdupq_n_f32(0.0f);
+		for (; i + 4 <= count; i += 4)
+		{
+			float32x4_t dx = vsubq_f32(vld1q_f32(xs + i), vpx);
+			float32x4_t dy = vsubq_f32(vld1q_f32(ys + i), vpy);
+			float32x4_t d2 = vmaxq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vmin);
+			float32x4_t mass = masses ? vld1q_f32(masses + i) : vone;
+			float32x4_t scale = vdivq_f32(mass, d2);
+			accX = vaddq_f32(accX, vmulq_f32(dx, scale));
+			accY = vaddq_f32(accY, vmulq_f32(dy, scale));
+		}
+		float lanesX[4];
+		float lanesY[4];
+		vst1q_f32(lanesX, accX);
+		vst1q_f32(lanesY, accY);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			sumX += lanesX[lane];
+			sumY += lanesY[lane];
+		}
+#endif
+
+		// Remainder (or everything, without SIMD).
+		for (; i < count; ++i)
+		{
+			float dx = xs[i] - px;
+			float dy = ys[i] - py;
+			float d2 = dx * dx + dy * dy;
+			if (d2 < MIN_DISTANCE_SQUARED)
+			{
+				d2 = MIN_DISTANCE_SQUARED;
+			}
+			float scale = (masses ? masses[i] : 1.0f) / d2;
+			sumX += dx * scale;
+			sumY += dy * scale;
+		}
+
+		fx -= repulsion * sumX;
+		fy -= repulsion * sumY;
+	}
+
+	void SumNeighborPositions(const float* xs, const float* ys, const unsigned int* neighbors, size_t count,
+		float& sumX, float& sumY)
+	{
+		sumX = 0.0f;
+		sumY = 0.0f;
+		size_t i = 0;
+
+#if defined(LAYOUT_KERNELS_AVX2)
+		__m256 accX = _mm256_setzero_ps();
+		__m256 accY = _mm256_setzero_ps();
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(neighbors + i));
+			accX = _mm256_add_ps(accX, _mm256_i32gather_ps(xs, index, 4));
+			accY = _mm256_add_ps(accY, _mm256_i32gather_ps(ys, index, 4));
+		}
+		alignas(32) float lanesX[8];
+		alignas(32) float lanesY[8];
+		_mm256_store_ps(lanesX, accX);
+		_mm256_store_ps(lanesY, accY);
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			sumX += lanesX[lane];
+			sumY += lanesY[lane];
+		}
+#else
+		// No gather instruction, four independent accumulators still keep the loads in flight.
+		float partialX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float partialY[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (; i + 4 <= count; i += 4)
+		{
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				partialX[lane] += xs[neighbors[i + lane]];
+				partialY[lane] += ys[neighbors[i + lane]];
+			}
+		}
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			sumX += partialX[lane];
+			sumY += partialY[lane];
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			sumX += xs[neighbors[i]];
+			sumY += ys[neighbors[i]];
+		}
+	}
+
+	const char* GetInstructionSet()
+	{
+#if defined(LAYOUT_KERNELS_AVX2)
+		return "AVX2";
+#elif defined(LAYOUT_KERNELS_SSE2)
+		return "SSE2";
+#elif defined(LAYOUT_KERNELS_NEON)
+		return "NEON";
+#else
+		return "Scalar";
+#endif
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+// Inner loops of the force-directed layout over structure-of-arrays data (separate contiguous x and y arrays).
+// Compiled for AVX2, SSE2 or NEON depending on the target, with a scalar fallback.
+// Lanes are always reduced in the same order, so a given build produces the same sums on every run.
+namespace LayoutKernels
+{
+	// Adds the ~1/r repulsion exerted on the point (px, py) by count bodies to (fx, fy).
+	// Per body: F = -(k * mass / r) * r_hat = -k * mass * dr / r^2, with r clamped to at least 1e-2.
+	// A body at exactly (px, py) contributes nothing, so the point itself may be included.
+	// masses may be nullptr, then every body has unit mass.
+	void AccumulateRepulsion(float px, float py, const float* xs, const float* ys, const float* masses, size_t count,
+		float repulsion, float& fx, float& fy);
+
+	// Sum of the positions of the given neighbors, gathered from the position arrays.
+	void SumNeighborPositions(const float* xs, const float* ys, const unsigned int* neighbors, size_t count,
+		float& sumX, float& sumY);
+
+	// Name of the instruction set the kernels were compiled for.
+	const char* GetInstructionSet();
+}
@@ -5,6 +5,9 @@
 
 struct Edge;
 
+// For simulation state prefer the property columns of Graph (addNodeProperty, addEdgeProperty, see PropertyMap.h).
+// Fields added to these structs make every node / edge larger, and the layout and the algorithms walk over them.
+
 struct Node
 {
 	sf::Vector2f position; // This is for rendering only. (position in world)
@@ -0,0 +1,169 @@
+#include "PageRank.h"
+#include "SpMV.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace PageRank
+{
+	namespace
+	{
+		// Sums over the nodes are taken per chunk, then added up in chunk order, so they do not depend on the threads.
+		constexpr size_t NODES_PER_CHUNK = 4096;
+
+		// parallelFor hands a task the whole range when it runs serially (one thread, a small graph, a nested call),
+		// so tasks split their range into the chunks again.
+		template<typename Chunk>
+		void ForEachChunk(size_t begin, size_t end, const Chunk& chunk)
+		{
+			for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += NODES_PER_CHUNK)
+			{
+				chunk(chunkBegin, std::min(chunkBegin + NODES_PER_CHUNK, end));
+			}
+		}
+	}
+
+	Result Run(const Graph& graph, const Options& options)
+	{
+		const CompressedAdjacency& inAdjacency = graph.getInAdjacency();
+		const std::vector<float> inWeights = options.weighted ? SpMV::GatherWeights(graph, inAdjacency) : std::vector<float>{};
+		return Run(graph.getOutAdjacency(), inAdjacency, inWeights, {}, options);
+	}
+
+	Result RunPersonalized(const Graph& graph, const std::vector<unsigned int>& seeds, const Options& options)
+	{
+		if (seeds.empty())
+			throw std::invalid_argument("Personalized PageRank needs at least one seed!");
+
+		std::vector<float> teleport(graph.getNumOfNodes(), 0.0f);
+		size_t numOfSeeds = 0;
+		for (unsigned int seed : seeds)
+		{
+			if (seed >= teleport.size())
+				throw std::invalid_argument("Seed node of the personalized PageRank does not exist!");
+
+			if (teleport[seed] == 0.0f)
+			{
+				teleport[seed] = 1.0f;
+				numOfSeeds++;
+			}
+		}
+		for (float& probability : teleport)
+		{
+			probability /= static_cast<float>(numOfSeeds);
+		}
+
+		const CompressedAdjacency& inAdjacency = graph.getInAdjacency();
+		const std::vector<float> inWeights = options.weighted ? SpMV::GatherWeights(graph, inAdjacency) : std::vector<float>{};
+		return Run(graph.getOutAdjacency(), inAdjacency, inWeights, teleport, options);
+	}
+
+	Result Run(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency,
+		const std::vector<float>& inWeights, const std::vector<float>& teleport, const Options& options)
+	{
+		const size_t numOfNodes = outAdjacency.offsets.size() - 1;
+		if (!(options.damping >= 0.0f && options.damping < 1.0f))
+			throw std::invalid_argument("PageRank damping must be in [0, 1)!");
+		if (!inWeights.empty() && inWeights.size() != inAdjacency.neighbors.size())
+			throw std::invalid_argument("PageRank needs one weight per in-edge!");
+		if (!teleport.empty() && teleport.size() != numOfNodes)
+			throw std::invalid_argument("PageRank needs one teleport probability per node!");
+
+		Result result;
+		if (numOfNodes == 0)
+		{
+			result.converged = true;
+			return result;
+		}
+
+		// Total weight leaving every node, by which its rank is divided among its out-edges.
+		const bool weighted = !inWeights.empty();
+		std::vector<double> outWeights(numOfNodes, 0.0);
+		if (weighted)
+		{
+			for (size_t k = 0; k < inWeights.size(); ++k)
+			{
+				if (inWeights[k] < 0.0f)
+					throw std::invalid_argument("Weighted PageRank needs non-negative edge weights!");
+
+				outWeights[inAdjacency.neighbors[k]] += inWeights[k];
+			}
+		}
+		else
+		{
+			for (size_t u = 0; u < numOfNodes; ++u)
+			{
+				outWeights[u] = outAdjacency.degree(u);
+			}
+		}
+
+		const float uniform = 1.0f / static_cast<float>(numOfNodes);
+		result.ranks = teleport.empty() ? std::vector<float>(numOfNodes, uniform) : teleport;
+		std::vector<float>& ranks = result.ranks;
+		std::vector<float> contributions(numOfNodes);
+		std::vector<float> sums(numOfNodes);
+		const size_t numOfChunks = (numOfNodes + NODES_PER_CHUNK - 1) / NODES_PER_CHUNK;
+		std::vector<double> danglingPartials(numOfChunks);
+		std::vector<double> errorPartials(numOfChunks);
+		ThreadPool& pool = ThreadPool::getGlobal();
+
+		// Rank every node sends along each unit of out-weight. Nodes without out-edges send theirs to the teleport.
+		// Takes one chunk of NODES_PER_CHUNK nodes.
+		auto updateContributions = [&](size_t begin, size_t end)
+			{
+				double dangling = 0.0;
+				for (size_t u = begin; u < end; ++u)
+				{
+					if (outWeights[u] > 0.0)
+					{
+						contributions[u] = static_cast<float>(ranks[u] / outWeights[u]);
+					}
+					else
+					{
+						contributions[u] = 0.0f;
+						dangling += ranks[u];
+					}
+				}
+				danglingPartials[begin / NODES_PER_CHUNK] = dangling;
+			};
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				ForEachChunk(begin, end, updateContributions);
+			}, NODES_PER_CHUNK);
+
+		while (result.numOfIterations < options.maxIterations)
+		{
+			SpMV::Pull(inAdjacency, contributions.data(), sums.data(), weighted ? inWeights.data() : nullptr);
+
+			const double dangling = std::accumulate(danglingPartials.begin(), danglingPartials.end(), 0.0);
+			const float teleportMass = static_cast<float>(1.0 - options.damping + options.damping * dangling);
+			pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+				{
+					ForEachChunk(begin, end, [&](size_t chunkBegin, size_t chunkEnd)
+						{
+							double error = 0.0;
+							for (size_t v = chunkBegin; v < chunkEnd; ++v)
+							{
+								const float rank = options.damping * sums[v] + teleportMass * (teleport.empty() ? uniform : teleport[v]);
+								error += std::abs(rank - ranks[v]);
+								ranks[v] = rank;
+							}
+							errorPartials[chunkBegin / NODES_PER_CHUNK] = error;
+							updateContributions(chunkBegin, chunkEnd);
+						});
+				}, NODES_PER_CHUNK);
+
+			result.numOfIterations++;
+			result.error = std::accumulate(errorPartials.begin(), errorPartials.end(), 0.0);
+			if (result.error < options.tolerance)
+			{
+				result.converged = true;
+				break;
+			}
+		}
+		return result;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Graph.h"
+#include "SparseMatrix.h"
+#include <vector>
+
+// PageRank by power iteration on SpMV::Pull over the in-edges. Rank flows along the edge directions, split among
+// the out-edges of a node evenly or, if weighted, in proportion to Edge::weight. The rank of nodes without
+// out-edges is handed back through the teleport distribution. Ranks sum to 1 and do not depend on the number of
+// threads.
+namespace PageRank
+{
+	struct Options
+	{
+		float damping = 0.85f;				// Probability of following an edge rather than teleporting, in [0, 1).
+		double tolerance = 1e-6;			// Stops once the L1 change of the ranks in an iteration is below this.
+		unsigned int maxIterations = 100;
+		bool weighted = false;				// Split rank by Edge::weight, which must then be non-negative.
+	};
+
+	struct Result
+	{
+		std::vector<float> ranks;
+		unsigned int numOfIterations = 0;
+		double error = 0.0;					// L1 change of the last iteration.
+		bool converged = false;
+	};
+
+	// Throws std::invalid_argument for a damping outside [0, 1) or, if weighted, a negative weight.
+	Result Run(const Graph& graph, const Options& options = {});
+	// Teleports to the seeds only, so the ranks measure closeness to them. Repeated seeds count once.
+	// Throws std::invalid_argument if there are no seeds or a seed does not exist.
+	Result RunPersonalized(const Graph& graph, const std::vector<unsigned int>& seeds, const Options& options = {});
+
+	// The same on bare adjacency. inWeights holds one weight per in-entry (see SpMV::GatherWeights) or is empty for
+	// unweighted ranks. teleport holds one probability per node summing to 1, or is empty for the uniform one.
+	Result Run(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency,
+		const std::vector<float>& inWeights, const std::vector<float>& teleport, const Options& options = {});
+}
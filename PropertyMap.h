@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Per-node or per-edge simulation state stored as columns: one contiguous array per property, indexed like the
+// nodes or edges. A kernel that only needs "opinion" scans one dense array of floats instead of striding through
+// whole Node structs. The graph keeps the columns the same length as its nodes / edges, including the swap and pop
+// of removals, so a column entry always belongs to the node or edge with the same index.
+
+// Common interface, so the graph can resize columns without knowing their types.
+class PropertyColumn
+{
+public:
+	virtual ~PropertyColumn() = default;
+
+	virtual void pushBack() = 0;
+	// Moves the last entry into index and drops the last one, like the removal of a node or an edge.
+	virtual void swapRemove(size_t index) = 0;
+	virtual void resize(size_t size) = 0;
+};
+
+// A single array. std::vector<bool> is not contiguous, use unsigned char (or a bit set of your own) for flags.
+template<typename T>
+class Property : public PropertyColumn
+{
+	static_assert(!std::is_same_v<T, bool>, "Use unsigned char instead of bool, std::vector<bool> is not contiguous.");
+
+public:
+	using ValueType = T;
+
+	Property(size_t size, const T& defaultValue)
+		: m_values(size, defaultValue),
+		  m_default{ defaultValue }
+	{
+	}
+
+	T& operator[](size_t index) { return m_values[index]; }
+	const T& operator[](size_t index) const { return m_values[index]; }
+	T* data() { return m_values.data(); }
+	const T* data() const { return m_values.data(); }
+	size_t size() const { return m_values.size(); }
+	void fill(const T& value) { std::fill(m_values.begin(), m_values.end(), value); }
+
+	void pushBack() override { m_values.push_back(m_default); }
+	void swapRemove(size_t index) override
+	{
+		m_values[index] = std::move(m_values.back());
+		m_values.pop_back();
+	}
+	void resize(size_t size) override { m_values.resize(size, m_default); }
+
+private:
+	std::vector<T> m_values;
+	T m_default;		// Value of the entries of new nodes / edges.
+};
+
+// Two arrays for synchronous updates: every node reads the current values of its neighbors and writes its own next
+// value, then swap() makes the next values current. Nobody reads a half updated state, so the update can be split
+// across threads freely.
+template<typename T>
+class DoubleBufferedProperty : public PropertyColumn
+{
+	static_assert(!std::is_same_v<T, bool>, "Use unsigned char instead of bool, std::vector<bool> is not contiguous.");
+
+public:
+	using ValueType = T;
+
+	DoubleBufferedProperty(size_t size, const T& defaultValue)
+		: m_current(size, defaultValue),
+		  m_next(size, defaultValue),
+		  m_default{ defaultValue }
+	{
+	}
+
+	const T& operator[](size_t index) const { return m_current[index]; }
+	const T* current() const { return m_current.data(); }
+	T* next() { return m_next.data(); }
+	void setNext(size_t index, const T& value) { m_next[index] = value; }
+	size_t size() const { return m_current.size(); }
+
+	// O(1), the arrays are exchanged, not copied. Entries not written since the last swap keep their older value,
+	// call copyCurrentToNext() first if only some of them are updated.
+	void swap() { m_current.swap(m_next); }
+	void copyCurrentToNext() { std::copy(m_current.begin(), m_current.end(), m_next.begin()); }
+	// Sets both buffers.
+	void set(size_t index, const T& value)
+	{
+		m_current[index] = value;
+		m_next[index] = value;
+	}
+
+	void pushBack() override
+	{
+		m_current.push_back(m_default);
+		m_next.push_back(m_default);
+	}
+	void swapRemove(size_t index) override
+	{
+		m_current[index] = std::move(m_current.back());
+		m_current.pop_back();
+		m_next[index] = std::move(m_next.back());
+		m_next.pop_back();
+	}
+	void resize(size_t size) override
+	{
+		m_current.resize(size, m_default);
+		m_next.resize(size, m_default);
+	}
+
+private:
+	std::vector<T> m_current;
+	std::vector<T> m_next;
+	T m_default;
+};
+
+// Named columns of one kind of element (nodes or edges), all of the same length.
+class PropertyMap
+{
+public:
+	// Adds a column with every entry set to defaultValue, or returns the existing one of that name.
+	// Throws std::invalid_argument if the name is taken by a column of another type.
+	template<typename Column>
+	Column& add(const std::string& name, const typename Column::ValueType& defaultValue)
+	{
+		auto it = m_columns.find(name);
+		if (it == m_columns.end())
+		{
+			it = m_columns.emplace(name, std::make_unique<Column>(m_size, defaultValue)).first;
+		}
+
+		Column* column = dynamic_cast<Column*>(it->second.get());
+		if (!column)
+			throw std::invalid_argument("Property \"" + name + "\" already exists with another type!");
+
+		return *column;
+	}
+
+	// nullptr if there is no column of that name and type.
+	template<typename Column>
+	Column* find(const std::string& name)
+	{
+		auto it = m_columns.find(name);
+		return it == m_columns.end() ? nullptr : dynamic_cast<Column*>(it->second.get());
+	}
+	template<typename Column>
+	const Column* find(const std::string& name) const
+	{
+		auto it = m_columns.find(name);
+		return it == m_columns.end() ? nullptr : dynamic_cast<const Column*>(it->second.get());
+	}
+
+	bool remove(const std::string& name) { return m_columns.erase(name) > 0; }
+	bool contains(const std::string& name) const { return m_columns.count(name) > 0; }
+
+	// Called by the graph when it adds or removes an element.
+	void pushBack()
+	{
+		for (auto& [name, column] : m_columns)
+		{
+			column->pushBack();
+		}
+		m_size++;
+	}
+	void swapRemove(size_t index)
+	{
+		for (auto& [name, column] : m_columns)
+		{
+			column->swapRemove(index);
+		}
+		m_size--;
+	}
+	void resize(size_t size)
+	{
+		for (auto& [name, column] : m_columns)
+		{
+			column->resize(size);
+		}
+		m_size = size;
+	}
+
+private:
+	std::unordered_map<std::string, std::unique_ptr<PropertyColumn>> m_columns;
+	size_t m_size = 0;
+};
@@ -0,0 +1,153 @@
+#include "QuadTree.h"
+
+#include <algorithm>
+#include <utility>
+
+void QuadTree::build(const std::vector<float>& x, const std::vector<float>& y)
+{
+	const size_t numOfNodes = x.size();
+	m_cells.clear();
+	m_leaves.clear();
+	m_leafBounds.clear();
+	m_order.resize(numOfNodes);
+	m_sortedX.resize(numOfNodes);
+	m_sortedY.resize(numOfNodes);
+	if (numOfNodes == 0)
+	{
+		return;
+	}
+
+	float minX = x[0], maxX = x[0];
+	float minY = y[0], maxY = y[0];
+	for (size_t i = 0; i < numOfNodes; ++i)
+	{
+		m_order[i] = static_cast<unsigned int>(i);
+		minX = std::min(minX, x[i]);
+		maxX = std::max(maxX, x[i]);
+		minY = std::min(minY, y[i]);
+		maxY = std::max(maxY, y[i]);
+	}
+
+	Cell root;
+	root.centerX = 0.5f * (minX + maxX);
+	root.centerY = 0.5f * (minY + maxY);
+	root.halfSize = 0.5f * std::max({ maxX - minX, maxY - minY, 1e-2f });
+	root.count = static_cast<unsigned int>(numOfNodes);
+	m_cells.push_back(root);
+
+	// Split cells top-down. Each split partitions the cell's range of m_order into its four quadrants,
+	// so no node is ever copied around and the whole build is O(N * depth).
+	std::vector<std::pair<int, int>> toSplit{ { 0, 0 } };
+	while (!toSplit.empty())
+	{
+		auto [cellIndex, depth] = toSplit.back();
+		toSplit.pop_back();
+
+		Cell cell = m_cells[cellIndex];
+		auto begin = m_order.begin() + cell.begin;
+		auto end = begin + cell.count;
+
+		float sumX = 0.0f;
+		float sumY = 0.0f;
+		for (auto it = begin; it != end; ++it)
+		{
+			sumX += x[*it];
+			sumY += y[*it];
+		}
+		m_cells[cellIndex].massCenterX = sumX / static_cast<float>(cell.count);
+		m_cells[cellIndex].massCenterY = sumY / static_cast<float>(cell.count);
+
+		if (cell.count <= LEAF_CAPACITY || depth >= MAX_DEPTH)
+		{
+			Bounds bounds{ x[*begin], y[*begin], x[*begin], y[*begin] };
+			for (auto it = begin; it != end; ++it)
+			{
+				bounds.minX = std::min(bounds.minX, x[*it]);
+				bounds.minY = std::min(bounds.minY, y[*it]);
+				bounds.maxX = std::max(bounds.maxX, x[*it]);
+				bounds.maxY = std::max(bounds.maxY, y[*it]);
+			}
+			m_leaves.push_back(cellIndex);
+			m_leafBounds.push_back(bounds);
+			continue;
+		}
+
+		// Quadrant order: (left, top), (right, top), (left, bottom), (right, bottom).
+		auto isLeft = [&](unsigned int i) { return x[i] < cell.centerX; };
+		auto isTop = [&](unsigned int i) { return y[i] < cell.centerY; };
+		auto middle = std::partition(begin, end, isTop);
+		std::vector<unsigned int>::iterator bounds[5] = { begin, std::partition(begin, middle, isLeft), middle, std::partition(middle, end, isLeft), end };
+
+		m_cells[cellIndex].firstChild = static_cast<int>(m_cells.size());
+		const float childHalf = 0.5f * cell.halfSize;
+		for (int q = 0; q < 4; ++q)
+		{
+			unsigned int childBegin = static_cast<unsigned int>(bounds[q] - m_order.begin());
+			unsigned int childCount = static_cast<unsigned int>(bounds[q + 1] - bounds[q]);
+			if (childCount == 0)
+			{
+				continue;
+			}
+
+			Cell child;
+			child.centerX = cell.centerX + ((q % 2 == 0) ? -childHalf : childHalf);
+			child.centerY = cell.centerY + ((q < 2) ? -childHalf : childHalf);
+			child.halfSize = childHalf;
+			child.begin = childBegin;
+			child.count = childCount;
+
+			m_cells[cellIndex].numOfChildren++;
+			toSplit.push_back({ static_cast<int>(m_cells.size()), depth + 1 });
+			m_cells.push_back(child);
+		}
+	}
+
+	for (size_t k = 0; k < numOfNodes; ++k)
+	{
+		m_sortedX[k] = x[m_order[k]];
+		m_sortedY[k] = y[m_order[k]];
+	}
+}
+
+void QuadTree::collectInteractions(size_t leaf, float theta, InteractionList& list) const
+{
+	const Bounds& bounds = m_leafBounds[leaf];
+	const float thetaSquared = theta * theta;
+
+	// Explicit stack, every level pushes at most 4 cells.
+	int stack[4 * MAX_DEPTH + 4];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const Cell& cell = m_cells[stack[--top]];
+
+		if (cell.firstChild < 0)
+		{
+			// Leaf: every node individually.
+			list.x.insert(list.x.end(), m_sortedX.begin() + cell.begin, m_sortedX.begin() + cell.begin + cell.count);
+			list.y.insert(list.y.end(), m_sortedY.begin() + cell.begin, m_sortedY.begin() + cell.begin + cell.count);
+			list.mass.insert(list.mass.end(), cell.count, 1.0f);
+			continue;
+		}
+
+		// Distance from the center of mass to the closest point of the leaf's bounding box.
+		float dx = std::max({ bounds.minX - cell.massCenterX, 0.0f, cell.massCenterX - bounds.maxX });
+		float dy = std::max({ bounds.minY - cell.massCenterY, 0.0f, cell.massCenterY - bounds.maxY });
+		float size = 2.0f * cell.halfSize;
+		if (size * size < thetaSquared * (dx * dx + dy * dy))
+		{
+			// Far away: the whole cell acts as one body.
+			list.x.push_back(cell.massCenterX);
+			list.y.push_back(cell.massCenterY);
+			list.mass.push_back(static_cast<float>(cell.count));
+			continue;
+		}
+
+		for (int c = 0; c < cell.numOfChildren; ++c)
+		{
+			stack[top++] = cell.firstChild + c;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Barnes-Hut quadtree over node positions. It is rebuilt every physics iteration (O(N log N))
+// and approximates the ~1/r repulsion of far away groups of nodes by their center of mass.
+class QuadTree
+{
+public:
+	// Bodies a node interacts with, as structure-of-arrays so they can be fed to LayoutKernels.
+	struct InteractionList
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> mass;
+
+		void clear()
+		{
+			x.clear();
+			y.clear();
+			mass.clear();
+		}
+	};
+
+	void build(const std::vector<float>& x, const std::vector<float>& y);
+
+	// Nodes are grouped into leaves of at most LEAF_CAPACITY nodes (more if they coincide).
+	// All nodes of a leaf share one interaction list, which amortizes the traversal over the group.
+	size_t getNumOfLeaves() const { return m_leaves.size(); }
+	// Indices of the nodes in a leaf.
+	const unsigned int* getLeafNodes(size_t leaf) const { return m_order.data() + m_cells[m_leaves[leaf]].begin; }
+	unsigned int getLeafSize(size_t leaf) const { return m_cells[m_leaves[leaf]].count; }
+
+	// Appends the bodies acting on the nodes of a leaf to list: far away cells as one body of mass "count"
+	// at their center of mass, nearby leaves node by node. A cell counts as far away when cellSize / distance < theta,
+	// distance being measured to the bounding box of the leaf, so theta = 0 lists every node.
+	// The leaf's own nodes are listed too, a node contributes no force on itself.
+	void collectInteractions(size_t leaf, float theta, InteractionList& list) const;
+
+private:
+	struct Cell
+	{
+		float centerX = 0.0f;		// Geometric center of the square.
+		float centerY = 0.0f;
+		float halfSize = 0.0f;
+		float massCenterX = 0.0f;
+		float massCenterY = 0.0f;
+		unsigned int count = 0;
+		unsigned int begin = 0;		// Range of this cell's nodes in m_order.
+		int firstChild = -1;		// Children are stored consecutively, -1 for leaves.
+		int numOfChildren = 0;
+	};
+
+	struct Bounds
+	{
+		float minX, minY, maxX, maxY;
+	};
+
+	static constexpr unsigned int LEAF_CAPACITY = 16;
+	static constexpr int MAX_DEPTH = 32;	// Coincident nodes would otherwise split forever.
+
+	std::vector<Cell> m_cells;
+	std::vector<int> m_leaves;			// Cell index of every leaf.
+	std::vector<Bounds> m_leafBounds;		// Tight bounding box of the nodes in every leaf.
+	std::vector<unsigned int> m_order;	// Node indices, grouped so that every cell owns a contiguous range.
+	std::vector<float> m_sortedX;		// Positions in m_order, so leaves are scanned contiguously.
+	std::vector<float> m_sortedY;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Priority queue for monotone integer keys (Ahuja, Mehlhorn, Orlin and Tarjan). An entry sits in the bucket of
+// the highest bit in which its key differs from the last popped key. When bucket 0 runs dry, the lowest
+// non-empty bucket is redistributed around its minimum, and every entry only ever moves to lower buckets.
+// Pushed keys must not be smaller than the last popped one, as in Dijkstra's algorithm.
+class RadixHeap
+{
+public:
+	bool empty() const { return m_size == 0; }
+
+	void push(std::uint64_t key, unsigned int node)
+	{
+		m_buckets[bucketOf(key)].emplace_back(key, node);
+		m_size++;
+	}
+
+	std::pair<std::uint64_t, unsigned int> pop()
+	{
+		if (m_buckets[0].empty())
+		{
+			size_t i = 1;
+			while (m_buckets[i].empty())
+			{
+				i++;
+			}
+			m_last = std::min_element(m_buckets[i].begin(), m_buckets[i].end())->first;
+			for (const auto& entry : m_buckets[i])
+			{
+				m_buckets[bucketOf(entry.first)].push_back(entry);
+			}
+			m_buckets[i].clear();
+		}
+		std::pair<std::uint64_t, unsigned int> entry = m_buckets[0].back();
+		m_buckets[0].pop_back();
+		m_size--;
+		return entry;
+	}
+
+	void clear()
+	{
+		for (auto& bucket : m_buckets)
+		{
+			bucket.clear();
+		}
+		m_last = 0;
+		m_size = 0;
+	}
+
+private:
+	size_t bucketOf(std::uint64_t key) const
+	{
+		return key == m_last ? 0 : 64 - std::countl_zero(key ^ m_last);
+	}
+
+	std::array<std::vector<std::pair<std::uint64_t, unsigned int>>, 65> m_buckets;
+	std::uint64_t m_last = 0;
+	size_t m_size = 0;
+};
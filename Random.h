@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+// Counter-based random number generator (Philox4x32-10, Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+// Every output is a pure function of the seed, the stream and the position in the stream, so independent streams
+// (e.g. one per block of rows) give the same numbers whichever thread draws them and in whatever order.
+// The helpers below are used instead of <random> distributions, whose results differ between standard libraries.
+class Philox
+{
+public:
+	Philox(std::uint64_t seed, std::uint64_t stream = 0)
+		: m_key{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) },
+		  m_counter{ 0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) }
+	{
+	}
+
+	// Uniform in [0, 2^32).
+	std::uint32_t nextUInt()
+	{
+		if (m_numOfBuffered == 0)
+		{
+			m_buffer = Block(m_counter, m_key);
+			m_numOfBuffered = 4;
+			// 64-bit position within the stream.
+			if (++m_counter[0] == 0)
+			{
+				++m_counter[1];
+			}
+		}
+		return m_buffer[--m_numOfBuffered];
+	}
+
+	// Uniform in [0, 1) with 53 random bits.
+	double nextDouble()
+	{
+		std::uint64_t bits = (static_cast<std::uint64_t>(nextUInt()) << 21) ^ (nextUInt() >> 11);
+		return static_cast<double>(bits & ((1ull << 53) - 1)) * (1.0 / 9007199254740992.0);
+	}
+
+	// Uniform in [0, bound), bound > 0. Unbiased (Lemire's multiply and reject).
+	std::uint32_t nextBelow(std::uint32_t bound)
+	{
+		std::uint64_t product = static_cast<std::uint64_t>(nextUInt()) * bound;
+		std::uint32_t low = static_cast<std::uint32_t>(product);
+		if (low < bound)
+		{
+			const std::uint32_t threshold = (0u - bound) % bound;
+			while (low < threshold)
+			{
+				product = static_cast<std::uint64_t>(nextUInt()) * bound;
+				low = static_cast<std::uint32_t>(product);
+			}
+		}
+		return static_cast<std::uint32_t>(product >> 32);
+	}
+
+	// 64 random bits for an arbitrary index, without stepping through the stream. Same seed, stream and index,
+	// same bits, so it can be evaluated in any order.
+	static std::uint64_t Hash(std::uint64_t seed, std::uint64_t stream, std::uint64_t index)
+	{
+		std::array<std::uint32_t, 4> bits = Block(
+			{ static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32), static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) },
+			{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) });
+		return (static_cast<std::uint64_t>(bits[0]) << 32) | bits[1];
+	}
+
+	// The Philox4x32 bijection with 10 rounds.
+	static std::array<std::uint32_t, 4> Block(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key)
+	{
+		constexpr std::uint32_t M0 = 0xD2511F53;
+		constexpr std::uint32_t M1 = 0xCD9E8D57;
+		constexpr std::uint32_t W0 = 0x9E3779B9;
+		constexpr std::uint32_t W1 = 0xBB67AE85;
+
+		for (int round = 0; round < 10; ++round)
+		{
+			if (round > 0)
+			{
+				key[0] += W0;
+				key[1] += W1;
+			}
+			const std::uint64_t product0 = static_cast<std::uint64_t>(M0) * counter[0];
+			const std::uint64_t product1 = static_cast<std::uint64_t>(M1) * counter[2];
+			counter = {
+				static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+				static_cast<std::uint32_t>(product1),
+				static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+				static_cast<std::uint32_t>(product0) };
+		}
+		return counter;
+	}
+
+	// Fresh seed for callers that do not care about reproducibility.
+	static std::uint64_t RandomSeed()
+	{
+		std::random_device rd;
+		return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+	}
+
+private:
+	std::array<std::uint32_t, 2> m_key;
+	std::array<std::uint32_t, 4> m_counter;
+	std::array<std::uint32_t, 4> m_buffer{};
+	int m_numOfBuffered = 0;
+};
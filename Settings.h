@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ThreadSettings.h"
 #include <SFML/Graphics.hpp>
 #include <string>
 
@@ -28,6 +29,12 @@ namespace Settings
 	constexpr float ATTRACTION_FORCE = 0.05f;    // Not increasing this above 0.1-0.2 is recommended. Otherwise exhibits weird behavior.
 	constexpr float REPULSION_FORCE = 0.1f;      // Same recommendation as above. 
 	constexpr float EDGE_ARROW_SIZE = 0.4f;
+	constexpr bool EXACT_REPULSION = false;      // Exact O(N^2) repulsion. Otherwise Barnes-Hut, O(N log N).
+	constexpr float BARNES_HUT_THETA = 0.8f;     // Opening angle of Barnes-Hut. Smaller is more accurate but slower, 0 is exact.
+	constexpr float LOD_NODE_POINT_PIXELS = 2.0f;  // Nodes smaller than this on screen are drawn as points.
+	constexpr float LOD_EDGE_LINE_PIXELS = 1.0f;   // Edges thinner than this on screen are drawn as lines.
+	constexpr float LOD_ARROW_PIXELS = 2.0f;       // Arrows smaller than this on screen are not drawn.
+	constexpr float SPATIAL_GRID_CELL_SIZE = 4.0f; // Cell size of the grid used for picking and spatial queries.
 
 	// ---------- TEXT ----------
 	constexpr unsigned int WEIGHT_FONT_SIZE = 12;
@@ -37,7 +44,14 @@ namespace Settings
 	// ---------- SIMULATION ----------
 	constexpr unsigned int NUMBER_OF_PHYSICS_ITERATIONS = 1000; // Number of physics iterations ran before the simulation begins.
 	constexpr bool DYNAMIC_PHYSICS = true; // If you set this to false, I recommend increasing the NUMBER_OF_PHYSICS_ITERATIONS.
-	constexpr bool SHOW_WEIGHTS = true;		// Performance intensive for large graphs.
+	constexpr bool SHOW_WEIGHTS = true;		// Drawn in a single batch, but rewriting moving labels still costs O(M) per frame.
 	constexpr float WEIGHT_TEXT_DISTANCE = 0.1f; // Positioning of weight indicators from edges.
 	constexpr bool DISPLAY_NODE_INFO = true;
+	constexpr float CLUSTERING_UPDATE_INTERVAL = 1.0f; // Seconds between recounts of the triangles shown in the node info while the topology changes.
+	constexpr bool THREADED_SIMULATION = false; // Step the simulation and physics on their own thread, decoupled from the frame rate.
+	constexpr unsigned long long HEADLESS_STEPS = 0; // Steps of a headless run. 0 means until stop() is called.
+	constexpr bool HEADLESS_PHYSICS = false; // Whether headless runs keep updating the layout.
+	constexpr float DENSE_ADJACENCY_DENSITY = 0.01f; // Graphs with at least this fraction of all possible edges also keep a bit matrix of them (O(1) hasEdge).
+	constexpr unsigned int DENSE_ADJACENCY_MAX_NODES = 32768; // The bit matrix takes N^2 / 8 bytes, 128 MB at this size.
+	// NUMBER_OF_THREADS is in ThreadSettings.h, so that GraphConvert builds without SFML.
 }
\ No newline at end of file
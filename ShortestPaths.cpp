@@ -0,0 +1,433 @@
+#include "ShortestPaths.h"
+#include "RadixHeap.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace ShortestPaths
+{
+	namespace
+	{
+		// O(N) buffers of one thread, reset after every query in time proportional to what the query touched.
+		struct Workspace
+		{
+			explicit Workspace(size_t numOfNodes)
+				: result{ std::vector<Distance>(numOfNodes, UNREACHABLE), std::vector<int>(numOfNodes, -1) }
+			{
+			}
+
+			void reset()
+			{
+				for (unsigned int node : touched)
+				{
+					result.distances[node] = UNREACHABLE;
+					result.parents[node] = -1;
+				}
+				touched.clear();
+				heap.clear();
+			}
+
+			Result result;
+			std::vector<unsigned int> touched;
+			RadixHeap heap;
+		};
+
+		// Settles nodes in order of distance, until target is settled if there is one (target < 0 otherwise).
+		void RunDijkstra(const WeightedAdjacency& adjacency, unsigned int source, long long target, Workspace& workspace)
+		{
+			std::vector<Distance>& distances = workspace.result.distances;
+			std::vector<int>& parents = workspace.result.parents;
+			distances[source] = 0;
+			parents[source] = static_cast<int>(source);
+			workspace.touched.push_back(source);
+			workspace.heap.push(0, source);
+
+			while (!workspace.heap.empty())
+			{
+				const auto [key, u] = workspace.heap.pop();
+				const Distance distance = static_cast<Distance>(key);
+				// Nodes are pushed again when they improve, the older entries are skipped.
+				if (distance != distances[u])
+				{
+					continue;
+				}
+				if (u == target)
+				{
+					break;
+				}
+
+				for (unsigned int k = adjacency.offsets[u]; k < adjacency.offsets[u + 1]; ++k)
+				{
+					const unsigned int v = adjacency.neighbors[k];
+					const Distance candidate = distance + adjacency.weights[k];
+					if (candidate < distances[v])
+					{
+						if (distances[v] == UNREACHABLE)
+						{
+							workspace.touched.push_back(v);
+						}
+						distances[v] = candidate;
+						parents[v] = static_cast<int>(u);
+						workspace.heap.push(static_cast<std::uint64_t>(candidate), v);
+					}
+					else if (candidate == distances[v] && static_cast<int>(u) < parents[v])
+					{
+						parents[v] = static_cast<int>(u);
+					}
+				}
+			}
+		}
+
+		void CheckNode(const WeightedAdjacency& adjacency, unsigned int node)
+		{
+			if (node >= adjacency.getNumOfNodes())
+				throw std::invalid_argument("Node of the shortest path query does not exist!");
+		}
+
+		// Runs fn(i, workspace) for every i in [0, count) in parallel, one workspace per thread, created on first use.
+		template<typename Function>
+		void ForEachQuery(const WeightedAdjacency& adjacency, size_t count, const Function& fn)
+		{
+			ThreadPool& pool = ThreadPool::getGlobal();
+			std::vector<std::unique_ptr<Workspace>> workspaces(pool.getNumOfThreads());
+			pool.parallelFor(0, count, [&](size_t begin, size_t end, unsigned int threadIndex)
+				{
+					if (!workspaces[threadIndex])
+					{
+						workspaces[threadIndex] = std::make_unique<Workspace>(adjacency.getNumOfNodes());
+					}
+					Workspace& workspace = *workspaces[threadIndex];
+					for (size_t i = begin; i < end; ++i)
+					{
+						fn(i, workspace);
+						workspace.reset();
+					}
+				}, 1);
+		}
+	}
+
+	WeightedAdjacency BuildWeightedAdjacency(const Graph& graph)
+	{
+		const CompressedAdjacency& out = graph.getOutAdjacency();
+		WeightedAdjacency adjacency;
+		adjacency.offsets = out.offsets;
+		adjacency.neighbors = out.neighbors;
+		adjacency.edges = out.edges;
+		adjacency.weights.resize(out.edges.size());
+		for (size_t k = 0; k < out.edges.size(); ++k)
+		{
+			const int weight = graph.getEdge(out.edges[k]).weight;
+			if (weight <= 0)
+				throw std::invalid_argument("Shortest paths need positive edge weights!");
+
+			adjacency.weights[k] = weight;
+			adjacency.maximumWeight = std::max(adjacency.maximumWeight, weight);
+		}
+		return adjacency;
+	}
+
+	Result Dijkstra(const WeightedAdjacency& adjacency, unsigned int source)
+	{
+		CheckNode(adjacency, source);
+		Workspace workspace{ adjacency.getNumOfNodes() };
+		RunDijkstra(adjacency, source, -1, workspace);
+		return std::move(workspace.result);
+	}
+
+	Result DeltaStepping(const WeightedAdjacency& adjacency, unsigned int source, Distance delta)
+	{
+		CheckNode(adjacency, source);
+		const size_t numOfNodes = adjacency.getNumOfNodes();
+		if (delta <= 0)
+		{
+			const Distance averageDegree = static_cast<Distance>(adjacency.neighbors.size() / std::max<size_t>(numOfNodes, 1));
+			delta = std::max<Distance>(1, adjacency.maximumWeight / std::max<Distance>(averageDegree, 1));
+		}
+
+		Result result{ std::vector<Distance>(numOfNodes, UNREACHABLE), std::vector<int>(numOfNodes, -1) };
+		std::vector<Distance>& distances = result.distances;
+		distances[source] = 0;
+		ThreadPool& pool = ThreadPool::getGlobal();
+
+		// The light edges (weight <= delta) again as CSR. They are relaxed every time a node improves within its bucket,
+		// the heavy ones only once the bucket is done, from the full rows.
+		std::vector<unsigned int> lightOffsets(numOfNodes + 1, 0);
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t u = begin; u < end; ++u)
+				{
+					unsigned int count = 0;
+					for (unsigned int k = adjacency.offsets[u]; k < adjacency.offsets[u + 1]; ++k)
+					{
+						count += adjacency.weights[k] <= delta ? 1 : 0;
+					}
+					lightOffsets[u + 1] = count;
+				}
+			}, 1024);
+		for (size_t u = 0; u < numOfNodes; ++u)
+		{
+			lightOffsets[u + 1] += lightOffsets[u];
+		}
+		std::vector<unsigned int> lightNeighbors(lightOffsets[numOfNodes]);
+		std::vector<int> lightWeights(lightOffsets[numOfNodes]);
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t u = begin; u < end; ++u)
+				{
+					unsigned int light = lightOffsets[u];
+					for (unsigned int k = adjacency.offsets[u]; k < adjacency.offsets[u + 1] && light < lightOffsets[u + 1]; ++k)
+					{
+						if (adjacency.weights[k] <= delta)
+						{
+							lightNeighbors[light] = adjacency.neighbors[k];
+							lightWeights[light] = adjacency.weights[k];
+							light++;
+						}
+					}
+				}
+			}, 1024);
+
+		// Every thread files the nodes it improves into its own buckets, keyed by distance / delta, so only the buckets
+		// in use take memory and empty ones are never visited. Improvements into the current bucket go to a plain vector.
+		// A node may be filed several times, the copies that no longer match its distance are skipped.
+		struct ThreadBuckets
+		{
+			std::map<size_t, std::vector<unsigned int>> later;
+			std::vector<unsigned int> current;
+			std::vector<unsigned int> settled;	// Nodes of the current bucket, once each.
+			size_t cachedIndex = SIZE_MAX;		// Last bucket of later filed into, map nodes do not move.
+			std::vector<unsigned int>* cached = nullptr;
+		};
+		std::vector<ThreadBuckets> buckets(pool.getNumOfThreads());
+		size_t bucket = 0;
+		buckets[0].current.push_back(source);
+
+		// Distance at which a node last relaxed its light edges. A node is settled in the bucket it last did so in.
+		std::vector<Distance> relaxedAt(numOfNodes, UNREACHABLE);
+
+		auto relax = [&](unsigned int v, Distance candidate, ThreadBuckets& own)
+			{
+				std::atomic_ref<Distance> target(distances[v]);
+				Distance current = target.load(std::memory_order_relaxed);
+				while (candidate < current)
+				{
+					if (target.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+					{
+						const size_t destination = static_cast<size_t>(candidate / delta);
+						if (destination == bucket)
+						{
+							own.current.push_back(v);
+						}
+						else
+						{
+							if (destination != own.cachedIndex)
+							{
+								own.cachedIndex = destination;
+								own.cached = &own.later[destination];
+							}
+							own.cached->push_back(v);
+						}
+						return;
+					}
+				}
+			};
+
+		std::vector<unsigned int> frontier;
+		while (true)
+		{
+			// Light edges, again and again until the bucket stays empty: they can lead back into it.
+			while (true)
+			{
+				frontier.clear();
+				for (ThreadBuckets& own : buckets)
+				{
+					frontier.insert(frontier.end(), own.current.begin(), own.current.end());
+					own.current.clear();
+				}
+				if (frontier.empty())
+				{
+					break;
+				}
+
+				pool.parallelFor(0, frontier.size(), [&](size_t begin, size_t end, unsigned int threadIndex)
+					{
+						ThreadBuckets& own = buckets[threadIndex];
+						for (size_t f = begin; f < end; ++f)
+						{
+							const unsigned int u = frontier[f];
+							const Distance distance = std::atomic_ref<Distance>(distances[u]).load(std::memory_order_relaxed);
+							if (static_cast<size_t>(distance / delta) != bucket)
+							{
+								continue;
+							}
+							const Distance previous = std::atomic_ref<Distance>(relaxedAt[u]).exchange(distance, std::memory_order_relaxed);
+							if (previous == distance)
+							{
+								continue;
+							}
+							if (previous == UNREACHABLE || static_cast<size_t>(previous / delta) != bucket)
+							{
+								own.settled.push_back(u);
+							}
+							for (unsigned int k = lightOffsets[u]; k < lightOffsets[u + 1]; ++k)
+							{
+								relax(lightNeighbors[k], distance + lightWeights[k], own);
+							}
+						}
+					}, 64);
+			}
+
+			// Heavy edges once per settled node, from its final distance. They cannot lead back into this bucket.
+			frontier.clear();
+			for (ThreadBuckets& own : buckets)
+			{
+				frontier.insert(frontier.end(), own.settled.begin(), own.settled.end());
+				own.settled.clear();
+			}
+			pool.parallelFor(0, frontier.size(), [&](size_t begin, size_t end, unsigned int threadIndex)
+				{
+					for (size_t f = begin; f < end; ++f)
+					{
+						const unsigned int u = frontier[f];
+						const Distance distance = distances[u];
+						for (unsigned int k = adjacency.offsets[u]; k < adjacency.offsets[u + 1]; ++k)
+						{
+							if (adjacency.weights[k] > delta)
+							{
+								relax(adjacency.neighbors[k], distance + adjacency.weights[k], buckets[threadIndex]);
+							}
+						}
+					}
+				}, 64);
+
+			// Straight to the smallest bucket any thread holds.
+			size_t next = SIZE_MAX;
+			for (const ThreadBuckets& own : buckets)
+			{
+				if (!own.later.empty())
+				{
+					next = std::min(next, own.later.begin()->first);
+				}
+			}
+			if (next == SIZE_MAX)
+			{
+				break;
+			}
+			bucket = next;
+			for (ThreadBuckets& own : buckets)
+			{
+				auto it = own.later.find(bucket);
+				if (it != own.later.end())
+				{
+					own.current.swap(it->second);
+					own.later.erase(it);
+				}
+				own.cachedIndex = SIZE_MAX;
+			}
+		}
+
+		// Parents from the final distances, the smallest tight predecessor wins whatever the order of relaxation.
+		std::vector<int>& parents = result.parents;
+		parents[source] = static_cast<int>(source);
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t u = begin; u < end; ++u)
+				{
+					if (distances[u] == UNREACHABLE)
+					{
+						continue;
+					}
+					for (unsigned int k = adjacency.offsets[u]; k < adjacency.offsets[u + 1]; ++k)
+					{
+						const unsigned int v = adjacency.neighbors[k];
+						if (v == source || distances[u] + adjacency.weights[k] != distances[v])
+						{
+							continue;
+						}
+						std::atomic_ref<int> parent(parents[v]);
+						int current = parent.load(std::memory_order_relaxed);
+						while ((current < 0 || static_cast<int>(u) < current)
+							&& !parent.compare_exchange_weak(current, static_cast<int>(u), std::memory_order_relaxed))
+						{
+						}
+					}
+				}
+			}, 1024);
+
+		return result;
+	}
+
+	std::vector<Distance> Distances(const WeightedAdjacency& adjacency, const std::vector<Query>& queries)
+	{
+		for (const Query& query : queries)
+		{
+			CheckNode(adjacency, query.source);
+			CheckNode(adjacency, query.target);
+		}
+
+		std::vector<Distance> distances(queries.size());
+		ForEachQuery(adjacency, queries.size(), [&](size_t i, Workspace& workspace)
+			{
+				RunDijkstra(adjacency, queries[i].source, queries[i].target, workspace);
+				distances[i] = workspace.result.distances[queries[i].target];
+			});
+		return distances;
+	}
+
+	void ForEachSource(const WeightedAdjacency& adjacency, const std::vector<unsigned int>& sources,
+		const std::function<void(size_t, const Result&)>& visit)
+	{
+		for (unsigned int source : sources)
+		{
+			CheckNode(adjacency, source);
+		}
+
+		ForEachQuery(adjacency, sources.size(), [&](size_t i, Workspace& workspace)
+			{
+				RunDijkstra(adjacency, sources[i], -1, workspace);
+				visit(i, workspace.result);
+			});
+	}
+
+	std::vector<unsigned int> GetPath(const Result& result, unsigned int target)
+	{
+		std::vector<unsigned int> path;
+		if (target >= result.parents.size() || result.parents[target] < 0)
+		{
+			return path;
+		}
+
+		unsigned int node = target;
+		path.push_back(node);
+		while (result.parents[node] != static_cast<int>(node))
+		{
+			node = static_cast<unsigned int>(result.parents[node]);
+			path.push_back(node);
+		}
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+
+	void ColorPath(Graph& graph, const Result& result, unsigned int target, sf::Color color)
+	{
+		const std::vector<unsigned int> path = GetPath(result, target);
+		for (size_t i = 0; i < path.size(); ++i)
+		{
+			graph.setNodeColor(path[i], color);
+			if (i > 0)
+			{
+				const int edge = graph.findEdge(path[i - 1], path[i]);
+				if (edge >= 0)
+				{
+					graph.setEdgeColor(edge, color);
+				}
+			}
+		}
+	}
+}
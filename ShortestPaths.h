@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Graph.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// Weighted single-source shortest paths along the edge directions, Edge::weight being the length of an edge.
+// Weights must be positive. Every function takes a WeightedAdjacency, built once per topology, so that many queries
+// share the setup: the weights are stored next to the neighbors instead of being fetched through Edge pointers.
+// Distances and parents do not depend on the number of threads: the parent of a node is the predecessor with the
+// smallest index among those on a shortest path.
+namespace ShortestPaths
+{
+	using Distance = std::int64_t;
+	constexpr Distance UNREACHABLE = std::numeric_limits<Distance>::max();
+
+	// Out-edges as CSR with the weights inline. Rows are sorted by neighbor.
+	struct WeightedAdjacency
+	{
+		std::vector<unsigned int> offsets{ 0 };
+		std::vector<unsigned int> neighbors;
+		std::vector<int> weights;
+		std::vector<unsigned int> edges;	// Index of every entry in the graph's edges.
+		int maximumWeight = 0;
+
+		size_t getNumOfNodes() const { return offsets.size() - 1; }
+	};
+
+	struct Result
+	{
+		std::vector<Distance> distances;	// UNREACHABLE if there is no path.
+		std::vector<int> parents;			// Previous node on a shortest path, the node itself for the source, -1 if unreachable.
+	};
+
+	struct Query
+	{
+		unsigned int source;
+		unsigned int target;
+	};
+
+	// Throws std::invalid_argument if a weight is not positive.
+	WeightedAdjacency BuildWeightedAdjacency(const Graph& graph);
+
+	// Serial Dijkstra on a radix heap, O(M + N log C) for the largest weight C. Fastest for a single query on small
+	// graphs, and the building block of the batch functions below.
+	Result Dijkstra(const WeightedAdjacency& adjacency, unsigned int source);
+
+	// Parallel delta-stepping (Meyer and Sanders). Nodes are settled in buckets of width delta, each bucket in parallel:
+	// light edges (weight <= delta) are relaxed until the bucket stays empty, heavy edges once after. Only non-empty
+	// buckets are kept and visited, so any delta >= 1 works, but delta far below the weights means many small buckets.
+	// delta = 0 picks the largest weight divided by the average degree. Pays off on large graphs with many threads.
+	Result DeltaStepping(const WeightedAdjacency& adjacency, unsigned int source, Distance delta = 0);
+
+	// Many independent queries at once, in parallel over the queries. Every thread reuses one set of O(N) buffers,
+	// resetting only what a query touched, so small queries cost no more than the part of the graph they explore.
+	// Point to point: every search stops as soon as its target is settled. Returns UNREACHABLE for unconnected pairs.
+	std::vector<Distance> Distances(const WeightedAdjacency& adjacency, const std::vector<Query>& queries);
+	// Full shortest path trees. visit(i, result) is called for sources[i] from the thread that ran it, possibly
+	// concurrently for different sources. The result is only valid during the call.
+	void ForEachSource(const WeightedAdjacency& adjacency, const std::vector<unsigned int>& sources,
+		const std::function<void(size_t, const Result&)>& visit);
+
+	// Nodes from the source to target along the parents, empty if target is unreachable.
+	std::vector<unsigned int> GetPath(const Result& result, unsigned int target);
+	// Colors the nodes and edges of the shortest path to target.
+	void ColorPath(Graph& graph, const Result& result, unsigned int target, sf::Color color = sf::Color::Green);
+}
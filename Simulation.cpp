@@ -1,9 +1,27 @@
 #include "Simulation.h"
+#include "Triangles.h"
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <thread>
 
 Simulation::Simulation(Graph* graph, const std::string& fontPath)
-	: m_graph{ graph }
+	: Simulation{ graph, SimulationMode::Windowed, fontPath }
+{
+}
+
+Simulation::Simulation(Graph* graph, SimulationMode mode, const std::string& fontPath)
+	: m_mode{ mode },
+	  m_graph{ graph }
+{
+	// Headless runs must work without a display, so nothing from the windowing side is touched.
+	if (m_mode == SimulationMode::Windowed)
+	{
+		createWindow(fontPath);
+	}
+}
+
+void Simulation::createWindow(const std::string& fontPath)
 {
 	if (Settings::ANTIALIASING > 0)
 	{
@@ -55,7 +73,7 @@ Simulation::Simulation(Graph* graph, const std::string& fontPath)
 void Simulation::handleInputs()
 {
 	// This should exist in all overrides.
-	Input::HandleInputs(m_window, m_inputState, m_view, *m_graph);
+	Input::HandleInputs(m_window, m_inputState, m_view);
 
 	// Scrolling
 	if (m_inputState.mouseLeftPressed)
@@ -72,6 +90,7 @@ void Simulation::handleInputs()
 		m_inputState.lastMouseWorldPos = m_window.mapPixelToCoords(m_inputState.lastMousePos);
 
 	}
+	dropStaleSelections();
 	m_nodeHeld = -1;
 	if (m_inputState.mouseRightPressed && m_inputState.selectedNodeIndexForMoving >= 0)
 	{
@@ -79,13 +98,79 @@ void Simulation::handleInputs()
 		m_injectMousePos = m_inputState.lastMouseWorldPos;
 	}
 
+	// While the simulation thread owns the graph, clicks are resolved there.
+	if (m_threaded)
+	{
+		exchangeInputWithSimulationThread();
+	}
+	else
+	{
+		if (m_inputState.infoPickRequested)
+		{
+			m_inputState.selectedNodeIndexForInfo = m_graph->findClosestNode(m_inputState.infoPickPosition);
+			m_infoSelectionRemovals = m_graph->getNumOfNodeRemovals();
+			m_inputState.infoPickRequested = false;
+		}
+		if (m_inputState.movePickRequested)
+		{
+			m_inputState.selectedNodeIndexForMoving = m_graph->findClosestNode(m_inputState.movePickPosition);
+			m_moveSelectionRemovals = m_graph->getNumOfNodeRemovals();
+			m_inputState.movePickRequested = false;
+		}
+	}
+
 	injectInputHandling();
 }
 
+void Simulation::exchangeInputWithSimulationThread()
+{
+	std::lock_guard<std::mutex> lock(m_sharedInputMutex);
+
+	// Clicks resolved since the last frame. A node is only picked up if the button is still down.
+	if (m_sharedInput.infoPickResult)
+	{
+		m_inputState.selectedNodeIndexForInfo = *m_sharedInput.infoPickResult;
+		m_infoSelectionRemovals = m_sharedInput.pickNodeRemovals;
+		m_sharedInput.infoPickResult.reset();
+	}
+	if (m_sharedInput.movePickResult)
+	{
+		if (m_inputState.mouseRightPressed)
+		{
+			m_inputState.selectedNodeIndexForMoving = *m_sharedInput.movePickResult;
+			m_moveSelectionRemovals = m_sharedInput.pickNodeRemovals;
+		}
+		m_sharedInput.movePickResult.reset();
+	}
+
+	// New clicks.
+	if (m_inputState.infoPickRequested)
+	{
+		m_sharedInput.infoPick = m_inputState.infoPickPosition;
+		m_inputState.infoPickRequested = false;
+	}
+	if (m_inputState.movePickRequested)
+	{
+		m_sharedInput.movePick = m_inputState.movePickPosition;
+		m_inputState.movePickRequested = false;
+	}
+
+	m_sharedInput.nodeHeld = m_nodeHeld;
+	m_sharedInput.infoNode = m_inputState.selectedNodeIndexForInfo;
+	m_sharedInput.injectMousePos = m_injectMousePos;
+}
+
 void Simulation::start()
 {
-	initializeInfoText();
+	if (m_mode == SimulationMode::Windowed)
+	{
+		initializeInfoText();
+	}
 	onStart();
+	if (m_mode == SimulationMode::Windowed)
+	{
+		updateNodeInfo(m_inputState.selectedNodeIndexForInfo, true);
+	}
 }
 
 void Simulation::onStart()
@@ -105,6 +190,18 @@ void Simulation::injectInputHandling()
 // Render/simulation loop.
 void Simulation::run()
 {
+	if (m_mode == SimulationMode::Headless)
+	{
+		runHeadless();
+		return;
+	}
+
+	if (Settings::THREADED_SIMULATION)
+	{
+		runThreaded();
+		return;
+	}
+
 	start();
 	while (m_window.isOpen())
 	{
@@ -117,49 +214,197 @@ void Simulation::run()
 		{
 			m_graph->updateGeometry(m_nodeHeld, m_injectMousePos);
 		}
+		updateNodeInfo(m_inputState.selectedNodeIndexForInfo, false);
 
 		m_window.clear(Settings::BACKGROUND_COLOR);
 		m_window.draw(*m_graph);
 
-		// Displaying node info
-		if (Settings::DISPLAY_NODE_INFO)
+		if (Settings::SHOW_WEIGHTS)
 		{
-			sf::View originalView = m_window.getView();
-			sf::View textView = m_window.getDefaultView();
-			m_window.setView(textView);
-			m_window.draw(*m_infoText);
-			m_window.setView(originalView);
-			setInfoText();
+			m_graph->getEdgeLabels(m_edgeLabelPositions, m_edgeWeights);
 		}
+		drawOverlays(m_edgeLabelPositions, m_edgeWeights);
 
-		if (Settings::SHOW_WEIGHTS)
+		m_window.display();
+
+		Input::ResetDeltas(m_inputState);
+	}
+}
+
+// Render loop of the threaded mode. The simulation thread steps and updates the physics at its own rate,
+// this thread only handles input and draws the newest snapshot it published.
+void Simulation::runThreaded()
+{
+	// onStart runs before the simulation thread exists, so it can still use the window.
+	start();
+
+	m_threaded = true;
+	m_stopSimulationThread = false;
+	std::thread simulationThread(&Simulation::simulationLoop, this);
+
+	sf::Clock rateClock;
+	uint64_t framesSinceLastReport = 0;
+	uint64_t stepsAtLastReport = m_currentTimeStep;
+
+	while (m_window.isOpen())
+	{
+		handleInputs();
+
+		m_snapshots.fetch();
+		const GraphSnapshot& snapshot = m_snapshots.getReadBuffer();
+
+		m_window.clear(Settings::BACKGROUND_COLOR);
+		m_window.draw(snapshot);
+		drawOverlays(snapshot.edgeLabelPositions, snapshot.edgeWeights);
+		m_window.display();
+
+		Input::ResetDeltas(m_inputState);
+
+		// Both rates are reported once per second.
+		framesSinceLastReport++;
+		float elapsed = rateClock.getElapsedTime().asSeconds();
+		if (elapsed >= 1.0f)
 		{
-			sf::View originalView = m_window.getView();
-			sf::View textView = m_window.getDefaultView();
-			m_window.setView(textView);
-			for (size_t i = 0; i < m_graph->getNumOfEdges(); ++i)
-			{
+			uint64_t steps = m_currentTimeStep;
+			const float frameRate = float(framesSinceLastReport) / elapsed;
+			const float stepRate = float(steps - stepsAtLastReport) / elapsed;
+			m_frameRate.store(frameRate, std::memory_order_relaxed);
+			m_stepRate.store(stepRate, std::memory_order_relaxed);
+			framesSinceLastReport = 0;
+			stepsAtLastReport = steps;
+			rateClock.restart();
+
+			std::stringstream title;
+			title << "Graph Engine | " << frameRate << " FPS | " << stepRate << " steps/s";
+			m_window.setTitle(title.str());
+		}
+	}
 
-				Edge& edge = m_graph->getEdge(i);
-				sf::Text text(m_font);
-				text.setString(std::to_string(edge.weight));
-				text.setCharacterSize(Settings::WEIGHT_FONT_SIZE);
-				text.setFillColor(Settings::FONT_COLOR);
+	m_stopSimulationThread = true;
+	simulationThread.join();
+	m_threaded = false;
+}
 
-				sf::Vector2f worldPos = edge.position + Settings::WEIGHT_TEXT_DISTANCE * edge.normal;
-				sf::Vector2i pixelPos = m_window.mapCoordsToPixel(worldPos, originalView);
-				sf::Vector2f pixelPosFloat = static_cast<sf::Vector2f>(pixelPos);
+void Simulation::simulationLoop()
+{
+	while (!m_stopSimulationThread)
+	{
+		int nodeHeld;
+		int infoNode;
+		sf::Vector2f injectMousePos;
+		std::optional<sf::Vector2f> infoPick;
+		std::optional<sf::Vector2f> movePick;
+		{
+			std::lock_guard<std::mutex> lock(m_sharedInputMutex);
+			nodeHeld = m_sharedInput.nodeHeld;
+			infoNode = m_sharedInput.infoNode;
+			injectMousePos = m_sharedInput.injectMousePos;
+			infoPick.swap(m_sharedInput.infoPick);
+			movePick.swap(m_sharedInput.movePick);
+		}
 
-				text.setPosition(pixelPosFloat);
-				m_window.draw(text);
+		bool updated = false;
+		if (m_isRunning && !m_isPaused)
+		{
+			step();
+			updated = true;
+		}
+		if (Settings::DYNAMIC_PHYSICS)
+		{
+			m_graph->updateGeometry(nodeHeld, injectMousePos);
+			updated = true;
+		}
+
+		std::optional<int> infoPickResult;
+		std::optional<int> movePickResult;
+		if (infoPick)
+		{
+			infoPickResult = m_graph->findClosestNode(*infoPick);
+			infoNode = *infoPickResult;
+		}
+		if (movePick)
+		{
+			movePickResult = m_graph->findClosestNode(*movePick);
+		}
+		// Published before the picks, so the render thread never checks a pick against older node info.
+		updateNodeInfo(infoNode, false);
+		if (infoPickResult || movePickResult)
+		{
+			std::lock_guard<std::mutex> lock(m_sharedInputMutex);
+			m_sharedInput.pickNodeRemovals = m_graph->getNumOfNodeRemovals();
+			if (infoPickResult)
+			{
+				m_sharedInput.infoPickResult = infoPickResult;
+			}
+			if (movePickResult)
+			{
+				m_sharedInput.movePickResult = movePickResult;
 			}
-			m_window.setView(originalView);
 		}
 
-		m_window.display();
+		// Only copy the graph when the render thread has taken the previous snapshot.
+		if (!m_snapshots.hasUnreadData())
+		{
+			m_graph->takeSnapshot(m_snapshots.getWriteBuffer());
+			m_snapshots.publish();
+		}
 
-		Input::ResetDeltas(m_inputState);
+		if (!updated)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
+
+void Simulation::drawOverlays(const std::vector<sf::Vector2f>& edgeLabelPositions, const std::vector<int>& edgeWeights)
+{
+	// Displaying node info
+	if (Settings::DISPLAY_NODE_INFO)
+	{
+		sf::View originalView = m_window.getView();
+		sf::View textView = m_window.getDefaultView();
+		m_window.setView(textView);
+		m_window.draw(*m_infoText);
+		m_window.setView(originalView);
+		setInfoText();
+	}
+
+	// All labels in one draw call, in world coordinates but at a constant size on screen.
+	if (Settings::SHOW_WEIGHTS)
+	{
+		float pixelSize = m_view.getSize().x / static_cast<float>(m_window.getSize().x);
+		m_weightLabels.update(edgeLabelPositions, edgeWeights, pixelSize);
+		m_window.draw(m_weightLabels);
+	}
+}
+
+void Simulation::runHeadless(uint64_t numOfSteps, bool withPhysics)
+{
+	start();
+
+	auto startTime = std::chrono::steady_clock::now();
+	uint64_t stepsTaken = 0;
+	while (m_isRunning && (numOfSteps == 0 || stepsTaken < numOfSteps))
+	{
+		// There is no input to unpause with, so a pause ends the run.
+		if (m_isPaused)
+		{
+			std::cerr << "WARNING::HEADLESS SIMULATION PAUSED, STOPPING" << std::endl;
+			break;
+		}
+
+		step();
+		stepsTaken++;
+
+		if (withPhysics)
+		{
+			m_graph->updateGeometry();
+		}
 	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Headless run finished: " << stepsTaken << " steps in " << seconds << " s ("
+		<< (seconds > 0.0 ? double(stepsTaken) / seconds : 0.0) << " steps/s)" << std::endl;
 }
 
 void Simulation::step()
@@ -168,6 +413,79 @@ void Simulation::step()
 	m_currentTimeStep += 1;
 }
 
+void Simulation::updateNodeInfo(int node, bool force)
+{
+	NodeInfo& info = m_nextNodeInfo;
+	const unsigned long long version = m_graph->getTopologyVersion();
+	// The selections are checked against these even without the info text.
+	info.numOfNodes = m_graph->getNumOfNodes();
+	info.numOfNodeRemovals = m_graph->getNumOfNodeRemovals();
+	if (Settings::DISPLAY_NODE_INFO && version != m_degreesVersion)
+	{
+		info.minimumDegree = m_graph->getMinimumDegree();
+		info.minimumInDegree = m_graph->getMinimumInDegree();
+		info.minimumOutDegree = m_graph->getMinimumOutDegree();
+		info.averageDegree = m_graph->getAverageDegree();
+		info.averageInDegree = m_graph->getAverageInDegree();
+		info.averageOutDegree = m_graph->getAverageOutDegree();
+		info.medianDegree = m_graph->getDegreeStatistics().getPercentile(DegreeStatistics::Kind::Total, 0.5f);
+		info.maximumDegree = m_graph->getMaximumDegree();
+		info.maximumInDegree = m_graph->getMaximumInDegree();
+		info.maximumOutDegree = m_graph->getMaximumOutDegree();
+		m_degreesVersion = version;
+	}
+
+	if (Settings::DISPLAY_NODE_INFO && version != m_clusteringVersion &&
+		(force || m_clusteringClock.getElapsedTime().asSeconds() >= Settings::CLUSTERING_UPDATE_INTERVAL))
+	{
+		Triangles::Result triangles = Triangles::Count(*m_graph);
+		m_localClustering = std::move(triangles.localClustering);
+		info.averageClustering = triangles.averageClustering;
+		info.transitivity = triangles.transitivity;
+		m_clusteringVersion = version;
+		m_clusteringClock.restart();
+	}
+
+	info.node = node >= 0 && node < info.numOfNodes ? node : -1;
+	info.inDegree = info.node >= 0 ? m_graph->getInDegree(info.node) : 0;
+	info.outDegree = info.node >= 0 ? m_graph->getOutDegree(info.node) : 0;
+	// Counted up to Settings::CLUSTERING_UPDATE_INTERVAL ago, the node may not have existed yet.
+	info.localClustering.reset();
+	if (info.node >= 0 && static_cast<size_t>(info.node) < m_localClustering.size())
+	{
+		info.localClustering = m_localClustering[info.node];
+	}
+
+	std::lock_guard<std::mutex> lock(m_nodeInfoMutex);
+	m_nodeInfo = info;
+}
+
+bool Simulation::dropStaleSelections()
+{
+	const NodeInfo info = getNodeInfo();
+	auto isStale = [&info](int selection, unsigned long long removals)
+		{
+			return selection >= info.numOfNodes || removals != info.numOfNodeRemovals;
+		};
+
+	if (m_inputState.selectedNodeIndexForMoving >= 0 && isStale(m_inputState.selectedNodeIndexForMoving, m_moveSelectionRemovals))
+	{
+		m_inputState.selectedNodeIndexForMoving = -1;
+	}
+	if (m_inputState.selectedNodeIndexForInfo >= 0 && isStale(m_inputState.selectedNodeIndexForInfo, m_infoSelectionRemovals))
+	{
+		m_inputState.selectedNodeIndexForInfo = -1;
+		return true;
+	}
+	return false;
+}
+
+Simulation::NodeInfo Simulation::getNodeInfo() const
+{
+	std::lock_guard<std::mutex> lock(m_nodeInfoMutex);
+	return m_nodeInfo;
+}
+
 void Simulation::onStep()
 {
 	// THIS IS WHERE YOU INJECT YOUR UPDATE CODE.
@@ -175,6 +493,8 @@ void Simulation::onStep()
 
 void Simulation::initializeInfoText()
 {
+	m_weightLabels.setFont(m_font, Settings::WEIGHT_FONT_SIZE);
+
 	m_infoText.emplace(m_font);
 	m_infoText->setCharacterSize(Settings::FONT_SIZE);
 	m_infoText->setFillColor(Settings::FONT_COLOR);
@@ -195,6 +515,14 @@ void Simulation::initializeInfoText()
 
 void Simulation::setInfoText()
 {
+	// Back to the placeholders if the selected node is gone.
+	if (dropStaleSelections())
+	{
+		std::stringstream ss;
+		injectInfoTextInitialization(ss);
+		m_infoText->setString(ss.str());
+	}
+
 	if (m_inputState.selectedNodeIndexForInfo >= 0)
 	{
 		int i = m_inputState.selectedNodeIndexForInfo;
@@ -213,31 +541,60 @@ void Simulation::setInfoText()
 void Simulation::injectInfoTextInitialization(std::stringstream& ss)
 {
 	ss << "Selected Node: " << "????????????????????????" << "\n"
+		<< "Degree (In / Out): " << "????????????????????????" << "\n"
 		<< "Minimum Degree: " << "????????????????????????" << "\n"
 		<< "Average Degree: " << "????????????????????????" << "\n"
+		<< "Median Degree: " << "????????????????????????" << "\n"
 		<< "Minimum In-Degree: " << "????????????????????????" << "\n"
 		<< "Minimum Out-Degree: " << "????????????????????????" << "\n"
 		<< "Average In-Degree: " << "????????????????????????" << "\n"
 		<< "Average Out-Degree: " << "????????????????????????" << "\n"
 		<< "Maximum Degree: " << "????????????????????????" << "\n"
 		<< "Maximum In-Degree: " << "????????????????????????" << "\n"
-		<< "Maximum Out-Degree: " << "????????????????????????" << "\n";
+		<< "Maximum Out-Degree: " << "????????????????????????" << "\n"
+		<< "Local Clustering: " << "????????????????????????" << "\n"
+		<< "Average Clustering: " << "????????????????????????" << "\n"
+		<< "Transitivity: " << "????????????????????????" << "\n";
 }
 
 void Simulation::injectInfoTextUpdate(int nodeIndex, std::stringstream& ss)
 {
-	Node& node = m_graph->getNode(nodeIndex);
+	const NodeInfo info = getNodeInfo();
 
+	// The simulation thread may not have seen a new selection yet.
 	ss << "Selected Node: " << nodeIndex << "\n"
-		<< "Minimum Degree: " << m_graph->getMinimumDegree() << "\n"
-		<< "Average Degree: " << m_graph->getAverageDegree() << "\n"
-		<< "Minimum In-Degree: " << m_graph->getMinimumInDegree() << "\n"
-		<< "Minimum Out-Degree: " << m_graph->getMinimumOutDegree() << "\n"
-		<< "Average In-Degree: " << m_graph->getAverageInDegree() << "\n"
-		<< "Average Out-Degree: " << m_graph->getAverageOutDegree() << "\n"
-		<< "Maximum Degree: " << m_graph->getMaximumDegree() << "\n"
-		<< "Maximum In-Degree: " << m_graph->getMaximumInDegree() << "\n"
-		<< "Maximum Out-Degree: " << m_graph->getMaximumOutDegree() << "\n";
+		<< "Degree (In / Out): ";
+	if (info.node == nodeIndex)
+	{
+		ss << info.inDegree << " / " << info.outDegree;
+	}
+	else
+	{
+		ss << "-";
+	}
+	ss << "\n"
+		<< "Minimum Degree: " << info.minimumDegree << "\n"
+		<< "Average Degree: " << info.averageDegree << "\n"
+		<< "Median Degree: " << info.medianDegree << "\n"
+		<< "Minimum In-Degree: " << info.minimumInDegree << "\n"
+		<< "Minimum Out-Degree: " << info.minimumOutDegree << "\n"
+		<< "Average In-Degree: " << info.averageInDegree << "\n"
+		<< "Average Out-Degree: " << info.averageOutDegree << "\n"
+		<< "Maximum Degree: " << info.maximumDegree << "\n"
+		<< "Maximum In-Degree: " << info.maximumInDegree << "\n"
+		<< "Maximum Out-Degree: " << info.maximumOutDegree << "\n"
+		<< "Local Clustering: ";
+	if (info.node == nodeIndex && info.localClustering)
+	{
+		ss << *info.localClustering;
+	}
+	else
+	{
+		ss << "-";
+	}
+	ss << "\n"
+		<< "Average Clustering: " << info.averageClustering << "\n"
+		<< "Transitivity: " << info.transitivity << "\n";
 }
 
 void Simulation::exportTractedDataToCSV(const std::string& fileName) const
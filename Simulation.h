@@ -2,17 +2,33 @@
 
 #include <SFML/Window.hpp>
 #include "Input.h"
+#include "TripleBuffer.h"
+#include "WeightLabels.h"
+#include <atomic>
 #include <cstdint>
 #include <map>
+#include <mutex>
+#include <optional>
+
+enum class SimulationMode
+{
+	Windowed,
+	Headless	// No window, no font and no drawing. Steps run back to back, for batch runs on servers.
+};
 
 class Simulation
 {
 public:
 	Simulation(Graph* graph, const std::string& fontPath = "../../../fonts/nasa.ttf");
+	Simulation(Graph* graph, SimulationMode mode, const std::string& fontPath = "../../../fonts/nasa.ttf");
 
 	virtual ~Simulation() = default;
 
+	// Windowed: render loop until the window closes. Headless: runHeadless with the defaults from Settings.
 	void run();
+	// Calls onStart, then onStep as fast as possible, numOfSteps times or until stop() (numOfSteps = 0).
+	// The layout physics are only updated if withPhysics is set. Works in both modes, never touches the window.
+	void runHeadless(uint64_t numOfSteps = Settings::HEADLESS_STEPS, bool withPhysics = Settings::HEADLESS_PHYSICS);
 	void stop()
 	{
 		m_isRunning = false;
@@ -34,6 +50,11 @@ public:
 	}
 	void exportTractedDataToCSV(const std::string& fileName) const;
 
+	// Measured once per second in threaded mode (Settings::THREADED_SIMULATION), also shown in the window title.
+	// Safe to call from onStep, the rates are written by the render thread.
+	float getStepRate() const { return m_stepRate.load(std::memory_order_relaxed); }
+	float getFrameRate() const { return m_frameRate.load(std::memory_order_relaxed); }
+
 protected:
 	virtual void onStart();
 	virtual void onStep();
@@ -41,7 +62,34 @@ protected:
 	virtual void injectInfoTextInitialization(std::stringstream& ss);
 	virtual void injectInfoTextUpdate(int nodeIndex, std::stringstream& ss);
 
+	// Figures shown in the node info. They are computed where the steps run and copied out under a mutex, so the
+	// info text functions can use them on the render thread in threaded mode, where they must not read the graph.
+	struct NodeInfo
+	{
+		int node = -1;						// Node the per-node values are for, -1 if none is selected.
+		unsigned int inDegree = 0;
+		unsigned int outDegree = 0;
+		std::optional<float> localClustering;	// Empty until the triangles are recounted after the node appeared.
+
+		int numOfNodes = 0;
+		unsigned long long numOfNodeRemovals = 0;	// See Graph::getNumOfNodeRemovals.
+		unsigned int minimumDegree = 0;
+		unsigned int minimumInDegree = 0;
+		unsigned int minimumOutDegree = 0;
+		float averageDegree = 0.0f;
+		float averageInDegree = 0.0f;
+		float averageOutDegree = 0.0f;
+		unsigned int medianDegree = 0;
+		unsigned int maximumDegree = 0;
+		unsigned int maximumInDegree = 0;
+		unsigned int maximumOutDegree = 0;
+		double averageClustering = 0.0;
+		double transitivity = 0.0;
+	};
+	NodeInfo getNodeInfo() const;
+
 protected:
+	SimulationMode m_mode;
 	sf::RenderWindow m_window;
 	sf::View m_view;
 	float m_aspectRatio = 0;
@@ -56,16 +104,68 @@ protected:
 
 	Graph* m_graph;
 
-	bool m_isRunning = true;
-	bool m_isPaused = false;
-	uint64_t m_currentTimeStep = 0;
+	// Atomic, since in threaded mode they are shared between the render and the simulation thread.
+	std::atomic<bool> m_isRunning{ true };
+	std::atomic<bool> m_isPaused{ false };
+	std::atomic<uint64_t> m_currentTimeStep{ 0 };
 
 private:
+	void createWindow(const std::string& fontPath);
 	void start();
 	void step();
 	void handleInputs();
 	void initializeInfoText();
 	void setInfoText();
+	void drawOverlays(const std::vector<sf::Vector2f>& edgeLabelPositions, const std::vector<int>& edgeWeights);
+	// Publishes the node info for the given node. The degree figures follow every change, the triangles are
+	// recounted at most once per Settings::CLUSTERING_UPDATE_INTERVAL unless forced. Runs where the steps run.
+	void updateNodeInfo(int node, bool force);
+	// Node indices move when nodes are removed, so selections made before a removal, or past the last node, are
+	// reset to -1. Checked against the published node info, true if the info selection was reset.
+	bool dropStaleSelections();
+
+	// Threaded mode. onStep and the physics run on the simulation thread, input and drawing on this one.
+	// injectInputHandling and the info text functions stay on the render thread and must not touch the graph.
+	void runThreaded();
+	void simulationLoop();
+	void exchangeInputWithSimulationThread();
+
+	struct SharedInput
+	{
+		int nodeHeld = -1;
+		int infoNode = -1;
+		sf::Vector2f injectMousePos = { 0.0f, 0.0f };
+		std::optional<sf::Vector2f> infoPick;
+		std::optional<sf::Vector2f> movePick;
+		std::optional<int> infoPickResult;
+		std::optional<int> movePickResult;
+		unsigned long long pickNodeRemovals = 0;	// Node removals when the results were picked.
+	};
+
+	bool m_threaded = false;
+	std::atomic<bool> m_stopSimulationThread{ false };
+	std::mutex m_sharedInputMutex;
+	SharedInput m_sharedInput;
+	TripleBuffer<GraphSnapshot> m_snapshots;
+	std::atomic<float> m_stepRate{ 0.0f };
+	std::atomic<float> m_frameRate{ 0.0f };
+
+	WeightLabels m_weightLabels;
+	std::vector<sf::Vector2f> m_edgeLabelPositions;
+	std::vector<int> m_edgeWeights;
+
+	// Only used where the steps run.
+	NodeInfo m_nextNodeInfo;
+	unsigned long long m_degreesVersion = ~0ull;
+	std::vector<float> m_localClustering;
+	unsigned long long m_clusteringVersion = ~0ull;
+	sf::Clock m_clusteringClock;
+
+	mutable std::mutex m_nodeInfoMutex;
+	NodeInfo m_nodeInfo;
+	// Node removals when the selections were picked, on the render thread.
+	unsigned long long m_infoSelectionRemovals = 0;
+	unsigned long long m_moveSelectionRemovals = 0;
 
 	std::map<std::string, std::vector<double>> m_trackedData;
 };
\ No newline at end of file
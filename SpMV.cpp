@@ -0,0 +1,127 @@
+#include "SpMV.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+
+#if defined(__AVX2__)
+	#define SPMV_AVX2
+	#include <immintrin.h>
+#endif
+
+namespace SpMV
+{
+	namespace
+	{
+		constexpr size_t ROWS_PER_CHUNK = 1024;
+	}
+
+	std::vector<float> GatherWeights(const Graph& graph, const CompressedAdjacency& adjacency)
+	{
+		std::vector<float> weights(adjacency.edges.size());
+		ThreadPool::getGlobal().parallelFor(0, weights.size(), [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t k = begin; k < end; ++k)
+				{
+					weights[k] = static_cast<float>(graph.getEdge(adjacency.edges[k]).weight);
+				}
+			}, 1 << 16);
+		return weights;
+	}
+
+	float GatherSum(const float* x, const unsigned int* indices, const float* weights, size_t count)
+	{
+		float sum = 0.0f;
+		size_t i = 0;
+
+#if defined(SPMV_AVX2)
+		__m256 acc = _mm256_setzero_ps();
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+			__m256 values = _mm256_i32gather_ps(x, index, 4);
+			acc = _mm256_add_ps(acc, weights ? _mm256_mul_ps(values, _mm256_loadu_ps(weights + i)) : values);
+		}
+		alignas(32) float lanes[8];
+		_mm256_store_ps(lanes, acc);
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			sum += lanes[lane];
+		}
+#else
+		// No gather instruction, four independent accumulators still keep the loads in flight.
+		float partial[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		if (weights)
+		{
+			for (; i + 4 <= count; i += 4)
+			{
+				for (int lane = 0; lane < 4; ++lane)
+				{
+					partial[lane] += weights[i + lane] * x[indices[i + lane]];
+				}
+			}
+		}
+		else
+		{
+			for (; i + 4 <= count; i += 4)
+			{
+				for (int lane = 0; lane < 4; ++lane)
+				{
+					partial[lane] += x[indices[i + lane]];
+				}
+			}
+		}
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			sum += partial[lane];
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			sum += (weights ? weights[i] : 1.0f) * x[indices[i]];
+		}
+		return sum;
+	}
+
+	void Pull(const CompressedAdjacency& adjacency, const float* x, float* y, const float* weights)
+	{
+		const size_t numOfRows = adjacency.offsets.size() - 1;
+		ThreadPool::getGlobal().parallelFor(0, numOfRows, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					const unsigned int first = adjacency.offsets[i];
+					y[i] = GatherSum(x, adjacency.neighbors.data() + first, weights ? weights + first : nullptr, adjacency.degree(i));
+				}
+			}, ROWS_PER_CHUNK);
+	}
+
+	void Push(const CompressedAdjacency& adjacency, const float* x, float* y, const float* weights)
+	{
+		const size_t numOfRows = adjacency.offsets.size() - 1;
+		ThreadPool& pool = ThreadPool::getGlobal();
+		const bool atomic = pool.getNumOfThreads() > 1;
+		pool.parallelFor(0, numOfRows, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					if (x[i] == 0.0f)
+					{
+						continue;
+					}
+					for (unsigned int k = adjacency.offsets[i]; k < adjacency.offsets[i + 1]; ++k)
+					{
+						const float value = (weights ? weights[k] : 1.0f) * x[i];
+						if (atomic)
+						{
+							std::atomic_ref<float>(y[adjacency.neighbors[k]]).fetch_add(value, std::memory_order_relaxed);
+						}
+						else
+						{
+							y[adjacency.neighbors[k]] += value;
+						}
+					}
+				}
+			}, ROWS_PER_CHUNK);
+	}
+}
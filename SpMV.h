@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Graph.h"
+#include "SparseMatrix.h"
+#include <cstddef>
+#include <vector>
+
+// Sparse matrix-vector products over the graph's adjacency, the inner loop of diffusion, averaging and ranking
+// updates. Rows of a CompressedAdjacency are the nodes, its entries their neighbors. weights, when given, hold one
+// value per entry (see GatherWeights), otherwise every entry counts as 1. Vectors are plain arrays, so both
+// std::vector::data() and DoubleBufferedProperty::current() / next() can be passed.
+// Push is the transpose of Pull over the same adjacency. y[v] = sum over edges u -> v of weight * x[u] is Pull over the
+// in-adjacency, or Push over the out-adjacency (into a zeroed y, with the weights gathered for the out-adjacency).
+namespace SpMV
+{
+	// Edge::weight of every entry of adjacency, in the order of adjacency.neighbors.
+	std::vector<float> GatherWeights(const Graph& graph, const CompressedAdjacency& adjacency);
+
+	// Sum of weights[i] * x[indices[i]] over count entries (weights may be nullptr). Vectorized with AVX2 gathers when
+	// compiled for it, otherwise four independent accumulators. Lanes are always reduced in the same order.
+	float GatherSum(const float* x, const unsigned int* indices, const float* weights, size_t count);
+
+	// y[i] = sum over the entries of row i of weight * x[neighbor], in parallel over the rows. Every row is written by
+	// exactly one thread, so the result does not depend on the number of threads. y must not alias x.
+	void Pull(const CompressedAdjacency& adjacency, const float* x, float* y, const float* weights = nullptr);
+
+	// y[neighbor] += weight * x[i] for every row i with x[i] != 0, in parallel over the rows. Only the rows of the
+	// non-zeros are read, so this beats Pull when x is sparse. y is added to, not overwritten. With more than one
+	// thread the additions are atomic and their order varies, which can change the last bits of y.
+	void Push(const CompressedAdjacency& adjacency, const float* x, float* y, const float* weights = nullptr);
+}
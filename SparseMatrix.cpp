@@ -0,0 +1,91 @@
+#include "SparseMatrix.h"
+
+#include <algorithm>
+
+SparseMatrix SparseMatrix::fromDense(const std::vector<std::vector<int>>& dense)
+{
+	SparseMatrix matrix;
+	matrix.numOfRows = static_cast<unsigned int>(dense.size());
+	matrix.offsets.reserve(dense.size() + 1);
+
+	for (size_t i = 0; i < dense.size(); ++i)
+	{
+		for (size_t j = 0; j < dense[i].size(); ++j)
+		{
+			if (dense[i][j] != 0)
+			{
+				matrix.columns.push_back(static_cast<unsigned int>(j));
+				matrix.values.push_back(dense[i][j]);
+			}
+		}
+		matrix.offsets.push_back(static_cast<unsigned int>(matrix.columns.size()));
+	}
+
+	return matrix;
+}
+
+SparseMatrix SparseMatrix::fromEntries(unsigned int numOfRows, std::vector<SparseEntry> entries)
+{
+	// Counting sort by row keeps this O(N + M), rows are then sorted individually (they are short).
+	std::vector<unsigned int> rowCounts(numOfRows + 1, 0);
+	for (const SparseEntry& entry : entries)
+	{
+		rowCounts[entry.row + 1]++;
+	}
+	for (unsigned int i = 0; i < numOfRows; ++i)
+	{
+		rowCounts[i + 1] += rowCounts[i];
+	}
+
+	std::vector<SparseEntry> sorted(entries.size());
+	std::vector<unsigned int> cursor(rowCounts.begin(), rowCounts.end() - 1);
+	for (const SparseEntry& entry : entries)
+	{
+		sorted[cursor[entry.row]++] = entry;
+	}
+	entries.clear();
+	entries.shrink_to_fit();
+
+	SparseMatrix matrix;
+	matrix.numOfRows = numOfRows;
+	matrix.offsets.reserve(numOfRows + 1);
+	matrix.columns.reserve(sorted.size());
+	matrix.values.reserve(sorted.size());
+
+	for (unsigned int i = 0; i < numOfRows; ++i)
+	{
+		auto rowBegin = sorted.begin() + rowCounts[i];
+		auto rowEnd = sorted.begin() + rowCounts[i + 1];
+		// Stable, so that among duplicates the entry given last stays last.
+		std::stable_sort(rowBegin, rowEnd, [](const SparseEntry& a, const SparseEntry& b) { return a.column < b.column; });
+
+		for (auto it = rowBegin; it != rowEnd; ++it)
+		{
+			if (it + 1 != rowEnd && (it + 1)->column == it->column)
+			{
+				continue;
+			}
+			if (it->value != 0)
+			{
+				matrix.columns.push_back(it->column);
+				matrix.values.push_back(it->value);
+			}
+		}
+		matrix.offsets.push_back(static_cast<unsigned int>(matrix.columns.size()));
+	}
+
+	return matrix;
+}
+
+std::vector<std::vector<int>> SparseMatrix::toDense() const
+{
+	std::vector<std::vector<int>> dense(numOfRows, std::vector<int>(numOfRows, 0));
+	for (unsigned int i = 0; i < numOfRows; ++i)
+	{
+		for (unsigned int k = offsets[i]; k < offsets[i + 1]; ++k)
+		{
+			dense[i][columns[k]] = values[k];
+		}
+	}
+	return dense;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// A single non-zero entry of a sparse matrix. For graphs: an edge row -> column with a weight.
+struct SparseEntry
+{
+	unsigned int row;
+	unsigned int column;
+	int value;
+};
+
+// Non-owning view of CSR data, of a SparseMatrix or of a memory-mapped graph file (see GraphFile.h).
+// values may be nullptr, then every entry is 1.
+struct SparseMatrixView
+{
+	unsigned int numOfRows = 0;
+	const unsigned int* offsets = nullptr;
+	const unsigned int* columns = nullptr;
+	const int* values = nullptr;
+
+	size_t getNumOfEntries() const { return numOfRows == 0 ? 0 : offsets[numOfRows]; }
+	int value(size_t k) const { return values ? values[k] : 1; }
+};
+
+// Compressed sparse row (CSR) matrix. Entries of row i are stored in [offsets[i], offsets[i + 1])
+// of columns/values and are sorted by column. Zeros are never stored, so memory is O(N + M) instead of O(N^2).
+struct SparseMatrix
+{
+	unsigned int numOfRows = 0;
+	std::vector<unsigned int> offsets{ 0 };
+	std::vector<unsigned int> columns;
+	std::vector<int> values;
+
+	size_t getNumOfEntries() const { return columns.size(); }
+	SparseMatrixView view() const { return { numOfRows, offsets.data(), columns.data(), values.data() }; }
+
+	// Zero entries of the dense matrix are skipped.
+	static SparseMatrix fromDense(const std::vector<std::vector<int>>& dense);
+	// Entries may come in any order. Zero values are dropped, for duplicates the last one wins.
+	static SparseMatrix fromEntries(unsigned int numOfRows, std::vector<SparseEntry> entries);
+
+	std::vector<std::vector<int>> toDense() const;
+};
+
+// Index structure the Graph keeps for its edges, one for out-edges (CSR) and one for in-edges (CSC).
+// For node i, its neighbors are neighbors[offsets[i] .. offsets[i + 1]) sorted by node index
+// (targets for out-edges, sources for in-edges), and edges[k] is the index of the Edge connecting them.
+struct CompressedAdjacency
+{
+	std::vector<unsigned int> offsets{ 0 };
+	std::vector<unsigned int> neighbors;
+	std::vector<unsigned int> edges;
+
+	unsigned int degree(size_t node) const { return offsets[node + 1] - offsets[node]; }
+};
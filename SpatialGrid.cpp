@@ -0,0 +1,229 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize)
+	: m_cellSize{ cellSize }
+{
+}
+
+void SpatialGrid::clear()
+{
+	m_cells.clear();
+	m_positions.clear();
+	m_cellKeys.clear();
+	m_slots.clear();
+	m_minCell = { 0, 0 };
+	m_maxCell = { -1, -1 };
+}
+
+SpatialGrid::CellCoordinates SpatialGrid::cellOf(sf::Vector2f position) const
+{
+	return { static_cast<int>(std::floor(position.x / m_cellSize)), static_cast<int>(std::floor(position.y / m_cellSize)) };
+}
+
+std::uint64_t SpatialGrid::key(CellCoordinates cell)
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.x)) << 32) | static_cast<std::uint32_t>(cell.y);
+}
+
+void SpatialGrid::addToCell(unsigned int id, std::uint64_t cellKey)
+{
+	std::vector<unsigned int>& cell = m_cells[cellKey];
+	m_cellKeys[id] = cellKey;
+	m_slots[id] = static_cast<unsigned int>(cell.size());
+	cell.push_back(id);
+
+	CellCoordinates coordinates = cellOf(m_positions[id]);
+	if (m_maxCell.x < m_minCell.x)
+	{
+		m_minCell = coordinates;
+		m_maxCell = coordinates;
+	}
+	m_minCell = { std::min(m_minCell.x, coordinates.x), std::min(m_minCell.y, coordinates.y) };
+	m_maxCell = { std::max(m_maxCell.x, coordinates.x), std::max(m_maxCell.y, coordinates.y) };
+}
+
+void SpatialGrid::removeFromCell(unsigned int id)
+{
+	auto it = m_cells.find(m_cellKeys[id]);
+	std::vector<unsigned int>& cell = it->second;
+
+	// Swap-and-pop inside the cell.
+	unsigned int last = cell.back();
+	cell[m_slots[id]] = last;
+	m_slots[last] = m_slots[id];
+	cell.pop_back();
+
+	if (cell.empty())
+	{
+		m_cells.erase(it);
+	}
+}
+
+void SpatialGrid::insert(sf::Vector2f position)
+{
+	unsigned int id = static_cast<unsigned int>(m_positions.size());
+	m_positions.push_back(position);
+	m_cellKeys.push_back(0);
+	m_slots.push_back(0);
+	addToCell(id, key(cellOf(position)));
+}
+
+void SpatialGrid::move(unsigned int id, sf::Vector2f position)
+{
+	m_positions[id] = position;
+	std::uint64_t newKey = key(cellOf(position));
+	if (newKey != m_cellKeys[id])
+	{
+		removeFromCell(id);
+		addToCell(id, newKey);
+	}
+}
+
+void SpatialGrid::swapRemove(unsigned int id)
+{
+	removeFromCell(id);
+
+	unsigned int last = static_cast<unsigned int>(m_positions.size() - 1);
+	if (id != last)
+	{
+		// The last point takes over id, only its entry in the cell list needs renaming.
+		m_cells[m_cellKeys[last]][m_slots[last]] = id;
+		m_positions[id] = m_positions[last];
+		m_cellKeys[id] = m_cellKeys[last];
+		m_slots[id] = m_slots[last];
+	}
+
+	m_positions.pop_back();
+	m_cellKeys.pop_back();
+	m_slots.pop_back();
+}
+
+template<typename Visit>
+void SpatialGrid::forEachInCells(int minX, int minY, int maxX, int maxY, Visit visit) const
+{
+	// Nothing lies outside of the occupied bounds.
+	minX = std::max(minX, m_minCell.x);
+	minY = std::max(minY, m_minCell.y);
+	maxX = std::min(maxX, m_maxCell.x);
+	maxY = std::min(maxY, m_maxCell.y);
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+
+	// For huge ranges, scanning the occupied cells is cheaper than probing every coordinate.
+	double numOfCoordinates = double(maxX - minX + 1) * double(maxY - minY + 1);
+	if (numOfCoordinates > double(m_cells.size()))
+	{
+		for (const auto& [cellKey, ids] : m_cells)
+		{
+			int x = static_cast<int>(static_cast<std::uint32_t>(cellKey >> 32));
+			int y = static_cast<int>(static_cast<std::uint32_t>(cellKey));
+			if (x >= minX && x <= maxX && y >= minY && y <= maxY)
+			{
+				for (unsigned int id : ids)
+				{
+					visit(id);
+				}
+			}
+		}
+		return;
+	}
+
+	for (int x = minX; x <= maxX; ++x)
+	{
+		for (int y = minY; y <= maxY; ++y)
+		{
+			auto it = m_cells.find(key({ x, y }));
+			if (it != m_cells.end())
+			{
+				for (unsigned int id : it->second)
+				{
+					visit(id);
+				}
+			}
+		}
+	}
+}
+
+int SpatialGrid::nearest(sf::Vector2f position, float maxDistance) const
+{
+	if (m_positions.empty())
+	{
+		return -1;
+	}
+
+	const CellCoordinates center = cellOf(position);
+	int closest = -1;
+	float minDistanceSquared = std::numeric_limits<float>::max();
+	auto visit = [&](unsigned int id)
+		{
+			float distanceSquared = (m_positions[id] - position).lengthSquared();
+			if (distanceSquared < minDistanceSquared || (distanceSquared == minDistanceSquared && static_cast<int>(id) < closest))
+			{
+				minDistanceSquared = distanceSquared;
+				closest = static_cast<int>(id);
+			}
+		};
+
+	// Search rings of cells around the center. Anything in ring r is at least r - 1 cells away.
+	const int maxRing = std::max({ center.x - m_minCell.x, m_maxCell.x - center.x, center.y - m_minCell.y, m_maxCell.y - center.y, 0 });
+	for (int ring = 0; ring <= maxRing; ++ring)
+	{
+		float ringDistance = static_cast<float>(std::max(ring - 1, 0)) * m_cellSize;
+		if (ringDistance > maxDistance || (closest >= 0 && ringDistance * ringDistance > minDistanceSquared))
+		{
+			break;
+		}
+
+		if (ring == 0)
+		{
+			forEachInCells(center.x, center.y, center.x, center.y, visit);
+			continue;
+		}
+		// Top and bottom rows, then the left and right columns without the corners.
+		forEachInCells(center.x - ring, center.y - ring, center.x + ring, center.y - ring, visit);
+		forEachInCells(center.x - ring, center.y + ring, center.x + ring, center.y + ring, visit);
+		forEachInCells(center.x - ring, center.y - ring + 1, center.x - ring, center.y + ring - 1, visit);
+		forEachInCells(center.x + ring, center.y - ring + 1, center.x + ring, center.y + ring - 1, visit);
+	}
+
+	if (closest >= 0 && minDistanceSquared > maxDistance * maxDistance)
+	{
+		return -1;
+	}
+	return closest;
+}
+
+void SpatialGrid::queryRadius(sf::Vector2f center, float radius, std::vector<unsigned int>& result) const
+{
+	CellCoordinates minCell = cellOf(center - sf::Vector2f{ radius, radius });
+	CellCoordinates maxCell = cellOf(center + sf::Vector2f{ radius, radius });
+	const float radiusSquared = radius * radius;
+	forEachInCells(minCell.x, minCell.y, maxCell.x, maxCell.y, [&](unsigned int id)
+		{
+			if ((m_positions[id] - center).lengthSquared() <= radiusSquared)
+			{
+				result.push_back(id);
+			}
+		});
+}
+
+void SpatialGrid::queryRect(const sf::FloatRect& rect, std::vector<unsigned int>& result) const
+{
+	sf::Vector2f minCorner = rect.position;
+	sf::Vector2f maxCorner = rect.position + rect.size;
+	CellCoordinates minCell = cellOf(minCorner);
+	CellCoordinates maxCell = cellOf(maxCorner);
+	forEachInCells(minCell.x, minCell.y, maxCell.x, maxCell.y, [&](unsigned int id)
+		{
+			sf::Vector2f p = m_positions[id];
+			if (p.x >= minCorner.x && p.x <= maxCorner.x && p.y >= minCorner.y && p.y <= maxCorner.y)
+			{
+				result.push_back(id);
+			}
+		});
+}
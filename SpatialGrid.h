@@ -0,0 +1,54 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over points, hashed so that it has no fixed bounds. Points are identified by dense ids
+// (node indices). Moving a point only touches the grid when it crosses into another cell, so keeping the
+// index in sync with the layout costs O(1) per node per iteration.
+class SpatialGrid
+{
+public:
+	explicit SpatialGrid(float cellSize = 4.0f);
+
+	void clear();
+	// ids must be added in order: the new id is size().
+	void insert(sf::Vector2f position);
+	void move(unsigned int id, sf::Vector2f position);
+	// Removes id by moving the last point into its place, like a swap-and-pop on the nodes.
+	void swapRemove(unsigned int id);
+	size_t size() const { return m_positions.size(); }
+
+	// Closest point to position within maxDistance, -1 if there is none.
+	int nearest(sf::Vector2f position, float maxDistance = std::numeric_limits<float>::max()) const;
+	// Appends every point within radius of center / inside rect to result.
+	void queryRadius(sf::Vector2f center, float radius, std::vector<unsigned int>& result) const;
+	void queryRect(const sf::FloatRect& rect, std::vector<unsigned int>& result) const;
+
+private:
+	struct CellCoordinates
+	{
+		int x;
+		int y;
+	};
+
+	CellCoordinates cellOf(sf::Vector2f position) const;
+	static std::uint64_t key(CellCoordinates cell);
+	void addToCell(unsigned int id, std::uint64_t cellKey);
+	void removeFromCell(unsigned int id);
+	template<typename Visit>
+	void forEachInCells(int minX, int minY, int maxX, int maxY, Visit visit) const;
+
+	float m_cellSize;
+	std::unordered_map<std::uint64_t, std::vector<unsigned int>> m_cells;
+	std::vector<sf::Vector2f> m_positions;
+	std::vector<std::uint64_t> m_cellKeys;		// Cell of every point.
+	std::vector<unsigned int> m_slots;			// Position of every point in its cell's list.
+
+	// Cells that have ever been occupied lie in here, it only grows until clear().
+	CellCoordinates m_minCell{ 0, 0 };
+	CellCoordinates m_maxCell{ -1, -1 };
+};
@@ -0,0 +1,124 @@
+#include "ThreadPool.h"
+#include "ThreadSettings.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Set while a thread is executing a task, nested parallelFor calls then run inline instead of deadlocking.
+	thread_local bool insideTask = false;
+}
+
+ThreadPool::ThreadPool(unsigned int numOfThreads)
+{
+	if (numOfThreads == 0)
+	{
+		numOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	m_workers.reserve(numOfThreads - 1);
+	for (unsigned int i = 1; i < numOfThreads; ++i)
+	{
+		m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wakeUp.notify_all();
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+ThreadPool& ThreadPool::getGlobal()
+{
+	static ThreadPool pool{ Settings::NUMBER_OF_THREADS };
+	return pool;
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t, unsigned int)>& task, size_t grainSize)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+	if (grainSize == 0)
+	{
+		grainSize = 1;
+	}
+
+	// Not worth waking anyone up.
+	if (insideTask || m_workers.empty() || end - begin <= grainSize)
+	{
+		bool wasInside = insideTask;
+		insideTask = true;
+		task(begin, end, 0);
+		insideTask = wasInside;
+		return;
+	}
+
+	std::lock_guard<std::mutex> submitLock(m_submitMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = &task;
+		m_end = end;
+		m_grainSize = grainSize;
+		m_next.store(begin);
+		m_activeWorkers = static_cast<unsigned int>(m_workers.size());
+		m_generation++;
+	}
+	m_wakeUp.notify_all();
+
+	runChunks(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_finished.wait(lock, [this] { return m_activeWorkers == 0; });
+	m_task = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned int threadIndex)
+{
+	unsigned long long seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeUp.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+			if (m_stopping)
+			{
+				return;
+			}
+			seenGeneration = m_generation;
+		}
+
+		runChunks(threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_activeWorkers--;
+		}
+		m_finished.notify_one();
+	}
+}
+
+void ThreadPool::runChunks(unsigned int threadIndex)
+{
+	insideTask = true;
+	while (true)
+	{
+		size_t chunkBegin = m_next.fetch_add(m_grainSize);
+		if (chunkBegin >= m_end)
+		{
+			break;
+		}
+		size_t chunkEnd = std::min(chunkBegin + m_grainSize, m_end);
+		(*m_task)(chunkBegin, chunkEnd, threadIndex);
+	}
+	insideTask = false;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads. Workers sleep between jobs, so handing out work every frame is cheap.
+// The calling thread takes part in every job, so a pool of N threads starts N - 1 workers.
+class ThreadPool
+{
+public:
+	// 0 means one thread per hardware thread.
+	explicit ThreadPool(unsigned int numOfThreads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned int getNumOfThreads() const { return static_cast<unsigned int>(m_workers.size()) + 1; }
+
+	// Splits [begin, end) into chunks of at most grainSize and calls task(chunkBegin, chunkEnd, threadIndex)
+	// until all are done. threadIndex is in [0, getNumOfThreads()) and can index per-thread scratch buffers.
+	// Which thread gets which chunk is not fixed: for reproducible results, a task should only write
+	// data owned by its chunk. Calls from inside a task run serially on the calling thread.
+	void parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t, unsigned int)>& task, size_t grainSize = 1024);
+
+	// Shared pool sized by Settings::NUMBER_OF_THREADS.
+	static ThreadPool& getGlobal();
+
+private:
+	void workerLoop(unsigned int threadIndex);
+	void runChunks(unsigned int threadIndex);
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	std::condition_variable m_finished;
+	std::mutex m_submitMutex;	// One job at a time.
+
+	// Current job.
+	const std::function<void(size_t, size_t, unsigned int)>* m_task = nullptr;
+	size_t m_end = 0;
+	size_t m_grainSize = 1;
+	std::atomic<size_t> m_next{ 0 };
+	unsigned int m_activeWorkers = 0;
+	unsigned long long m_generation = 0;
+	bool m_stopping = false;
+};
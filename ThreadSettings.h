@@ -0,0 +1,7 @@
+#pragma once
+
+// Settings that code without SFML needs (GraphConvert), included by Settings.h.
+namespace Settings
+{
+	constexpr unsigned int NUMBER_OF_THREADS = 0; // Threads used by the layout and the algorithms. 0 means all hardware threads.
+}
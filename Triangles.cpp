@@ -0,0 +1,252 @@
+#include "Triangles.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define TRIANGLES_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace Triangles
+{
+	namespace
+	{
+		constexpr size_t NODES_PER_CHUNK = 256;		// Small, the work per node varies a lot.
+
+		// Calls visit(neighbor) for the union of the out- and in-neighbors of node, in increasing order.
+		template<typename Visit>
+		void ForEachNeighbor(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency, size_t node, const Visit& visit)
+		{
+			unsigned int i = outAdjacency.offsets[node];
+			unsigned int j = inAdjacency.offsets[node];
+			const unsigned int endI = outAdjacency.offsets[node + 1];
+			const unsigned int endJ = inAdjacency.offsets[node + 1];
+			while (i < endI || j < endJ)
+			{
+				if (j == endJ || (i < endI && outAdjacency.neighbors[i] < inAdjacency.neighbors[j]))
+				{
+					visit(outAdjacency.neighbors[i++]);
+				}
+				else if (i == endI || inAdjacency.neighbors[j] < outAdjacency.neighbors[i])
+				{
+					visit(inAdjacency.neighbors[j++]);
+				}
+				else
+				{
+					visit(outAdjacency.neighbors[i]);
+					i++;
+					j++;
+				}
+			}
+		}
+
+		void Add(unsigned long long& counter, unsigned long long value)
+		{
+			std::atomic_ref<unsigned long long>(counter).fetch_add(value, std::memory_order_relaxed);
+		}
+	}
+
+	size_t Intersect(const unsigned int* a, size_t countA, const unsigned int* b, size_t countB, unsigned int* common)
+	{
+		size_t i = 0;
+		size_t j = 0;
+		size_t count = 0;
+
+#if defined(TRIANGLES_SSE2)
+		// Every value of a block of a is compared with all four rotations of a block of b. The block with the smaller
+		// last value cannot match anything further on and is advanced, both on a tie.
+		while (i + 4 <= countA && j + 4 <= countB)
+		{
+			const __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+			__m128i equal = _mm_cmpeq_epi32(blockA, blockB);
+			equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(0, 3, 2, 1))));
+			equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(1, 0, 3, 2))));
+			equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(2, 1, 0, 3))));
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+			while (mask)
+			{
+				const int lane = std::countr_zero(static_cast<unsigned int>(mask));
+				common[count++] = a[i + lane];
+				mask &= mask - 1;
+			}
+
+			const unsigned int lastA = a[i + 3];
+			const unsigned int lastB = b[j + 3];
+			if (lastA <= lastB)
+			{
+				i += 4;
+			}
+			if (lastB <= lastA)
+			{
+				j += 4;
+			}
+		}
+#endif
+
+		// Remainder (or everything, without SSE2).
+		while (i < countA && j < countB)
+		{
+			if (a[i] < b[j])
+			{
+				i++;
+			}
+			else if (b[j] < a[i])
+			{
+				j++;
+			}
+			else
+			{
+				common[count++] = a[i];
+				i++;
+				j++;
+			}
+		}
+		return count;
+	}
+
+	Result Count(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency)
+	{
+		const size_t numOfNodes = outAdjacency.offsets.size() - 1;
+		ThreadPool& pool = ThreadPool::getGlobal();
+
+		std::vector<unsigned int> degrees(numOfNodes);
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t u = begin; u < end; ++u)
+				{
+					unsigned int degree = 0;
+					ForEachNeighbor(outAdjacency, inAdjacency, u, [&](unsigned int) { degree++; });
+					degrees[u] = degree;
+				}
+			}, NODES_PER_CHUNK);
+
+		// Nodes renamed by their rank in (degree, index) order, a stable counting sort by degree. Every node keeps the
+		// ranks of its later neighbors, sorted, as CSR.
+		std::vector<unsigned int> ranks(numOfNodes);
+		{
+			const unsigned int maximumDegree = numOfNodes > 0 ? *std::max_element(degrees.begin(), degrees.end()) : 0;
+			std::vector<unsigned int> starts(maximumDegree + 2, 0);
+			for (unsigned int degree : degrees)
+			{
+				starts[degree + 1]++;
+			}
+			for (size_t d = 0; d + 1 < starts.size(); ++d)
+			{
+				starts[d + 1] += starts[d];
+			}
+			for (size_t u = 0; u < numOfNodes; ++u)
+			{
+				ranks[u] = starts[degrees[u]]++;
+			}
+		}
+		std::vector<unsigned int> offsets(numOfNodes + 1, 0);
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t u = begin; u < end; ++u)
+				{
+					unsigned int count = 0;
+					ForEachNeighbor(outAdjacency, inAdjacency, u, [&](unsigned int v) { count += ranks[v] > ranks[u] ? 1 : 0; });
+					offsets[ranks[u] + 1] = count;
+				}
+			}, NODES_PER_CHUNK);
+		unsigned int maximumCount = 0;
+		for (size_t r = 0; r < numOfNodes; ++r)
+		{
+			maximumCount = std::max(maximumCount, offsets[r + 1]);
+			offsets[r + 1] += offsets[r];
+		}
+		std::vector<unsigned int> later(offsets[numOfNodes]);
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t u = begin; u < end; ++u)
+				{
+					const unsigned int first = offsets[ranks[u]];
+					unsigned int k = first;
+					ForEachNeighbor(outAdjacency, inAdjacency, u, [&](unsigned int v)
+						{
+							if (ranks[v] > ranks[u])
+							{
+								later[k++] = ranks[v];
+							}
+						});
+					std::sort(later.begin() + first, later.begin() + k);
+				}
+			}, NODES_PER_CHUNK);
+
+		// A triangle r < s < t is found once, from the edge r - s, among the neighbors of r after s, and counted at
+		// all three corners.
+		std::vector<unsigned long long> trianglesByRank(numOfNodes, 0);
+		std::vector<std::unique_ptr<std::vector<unsigned int>>> buffers(pool.getNumOfThreads());
+		pool.parallelFor(0, numOfNodes, [&](size_t begin, size_t end, unsigned int threadIndex)
+			{
+				if (!buffers[threadIndex])
+				{
+					buffers[threadIndex] = std::make_unique<std::vector<unsigned int>>(maximumCount);
+				}
+				unsigned int* common = buffers[threadIndex]->data();
+				for (size_t r = begin; r < end; ++r)
+				{
+					unsigned long long trianglesOfR = 0;
+					for (unsigned int k = offsets[r]; k < offsets[r + 1]; ++k)
+					{
+						const unsigned int s = later[k];
+						const size_t count = Intersect(later.data() + k + 1, offsets[r + 1] - k - 1,
+							later.data() + offsets[s], offsets[s + 1] - offsets[s], common);
+						if (count == 0)
+						{
+							continue;
+						}
+						trianglesOfR += count;
+						Add(trianglesByRank[s], count);
+						for (size_t c = 0; c < count; ++c)
+						{
+							Add(trianglesByRank[common[c]], 1);
+						}
+					}
+					if (trianglesOfR > 0)
+					{
+						Add(trianglesByRank[r], trianglesOfR);
+					}
+				}
+			}, NODES_PER_CHUNK);
+
+		Result result;
+		result.triangles.resize(numOfNodes);
+		for (size_t u = 0; u < numOfNodes; ++u)
+		{
+			result.triangles[u] = trianglesByRank[ranks[u]];
+		}
+
+		result.localClustering.assign(numOfNodes, 0.0f);
+		unsigned long long cornerSum = 0;
+		unsigned long long wedges = 0;
+		double clusteringSum = 0.0;
+		for (size_t u = 0; u < numOfNodes; ++u)
+		{
+			const unsigned long long degree = degrees[u];
+			const unsigned long long pairs = degree < 2 ? 0 : degree * (degree - 1) / 2;
+			if (pairs > 0)
+			{
+				const double clustering = static_cast<double>(result.triangles[u]) / static_cast<double>(pairs);
+				result.localClustering[u] = static_cast<float>(clustering);
+				clusteringSum += clustering;
+			}
+			cornerSum += result.triangles[u];
+			wedges += pairs;
+		}
+		result.numOfTriangles = cornerSum / 3;
+		result.transitivity = wedges > 0 ? static_cast<double>(cornerSum) / static_cast<double>(wedges) : 0.0;
+		result.averageClustering = numOfNodes > 0 ? clusteringSum / static_cast<double>(numOfNodes) : 0.0;
+		return result;
+	}
+
+	Result Count(const Graph& graph)
+	{
+		return Count(graph.getOutAdjacency(), graph.getInAdjacency());
+	}
+}
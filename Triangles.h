@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Graph.h"
+#include "SparseMatrix.h"
+#include <cstddef>
+#include <vector>
+
+// Triangle counting and clustering coefficients, ignoring edge directions: u and v are neighbors if there is an edge
+// either way, and an edge in both directions counts once. Every node keeps only its neighbors that come later in
+// (degree, index) order, which bounds those lists by O(sqrt(M)), and every triangle is found exactly once by
+// intersecting the sorted lists of the two earlier corners. Runs in parallel over the nodes, the counts do not depend
+// on the number of threads.
+namespace Triangles
+{
+	struct Result
+	{
+		std::vector<unsigned long long> triangles;	// Triangles through every node.
+		std::vector<float> localClustering;			// Fraction of the pairs of neighbors that are connected, 0 below 2 neighbors.
+		unsigned long long numOfTriangles = 0;
+		double transitivity = 0.0;					// 3 * triangles / pairs of edges sharing a node, over the whole graph.
+		double averageClustering = 0.0;				// Mean of the local clustering over all nodes.
+	};
+
+	Result Count(const CompressedAdjacency& outAdjacency, const CompressedAdjacency& inAdjacency);
+	Result Count(const Graph& graph);
+
+	// Writes the values found in both sorted, duplicate free arrays to common (room for min(countA, countB) values)
+	// and returns how many there are. Compares blocks of 4 x 4 values at once with SSE2 when compiled for it.
+	size_t Intersect(const unsigned int* a, size_t countA, const unsigned int* b, size_t countB, unsigned int* common);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free triple buffer for one writer thread and one reader thread. The writer fills its buffer and publishes it,
+// the reader picks up the newest published buffer whenever it wants. Neither side ever waits for the other,
+// and the reader never sees a half written buffer.
+template<typename T>
+class TripleBuffer
+{
+public:
+	// Writer side.
+	T& getWriteBuffer()
+	{
+		return m_buffers[m_writeIndex];
+	}
+	void publish()
+	{
+		int previous = m_shared.exchange(m_writeIndex | NEW_DATA, std::memory_order_acq_rel);
+		m_writeIndex = previous & INDEX_MASK;
+	}
+	// True while the last published buffer has not been fetched. Writers can skip filling buffers nobody will see.
+	bool hasUnreadData() const
+	{
+		return (m_shared.load(std::memory_order_acquire) & NEW_DATA) != 0;
+	}
+
+	// Reader side. Switches to the newest published buffer, returns false if nothing new was published.
+	bool fetch()
+	{
+		if (!hasUnreadData())
+		{
+			return false;
+		}
+		int previous = m_shared.exchange(m_readIndex, std::memory_order_acq_rel);
+		m_readIndex = previous & INDEX_MASK;
+		return true;
+	}
+	const T& getReadBuffer() const
+	{
+		return m_buffers[m_readIndex];
+	}
+
+private:
+	static constexpr int INDEX_MASK = 3;
+	static constexpr int NEW_DATA = 4;
+
+	T m_buffers[3];
+	int m_writeIndex = 0;				// Only touched by the writer.
+	int m_readIndex = 1;				// Only touched by the reader.
+	std::atomic<int> m_shared{ 2 };		// The buffer in between, plus the NEW_DATA flag.
+};
@@ -0,0 +1,110 @@
+#include "ViewCuller.h"
+#include "Settings.h"
+
+namespace
+{
+	void Reserve(std::vector<sf::Vertex>& buffer, size_t size)
+	{
+		if (buffer.size() < size)
+		{
+			buffer.resize(size);
+		}
+	}
+}
+
+void ViewCuller::draw(sf::RenderTarget& target, sf::RenderStates states,
+	const sf::VertexArray& nodeVertices, const std::vector<Bounds>& nodeBounds,
+	const sf::VertexArray& edgeVertices, const std::vector<Bounds>& edgeBounds)
+{
+	states.texture = nullptr;
+
+	// The view in the local coordinates of the vertices.
+	const sf::View& view = target.getView();
+	sf::FloatRect viewRect{ view.getCenter() - 0.5f * view.getSize(), view.getSize() };
+	viewRect = states.transform.getInverse().transformRect(viewRect);
+	const Bounds visible{ viewRect.position.x, viewRect.position.y, viewRect.position.x + viewRect.size.x, viewRect.position.y + viewRect.size.y };
+	const float pixelsPerUnit = viewRect.size.x > 0.0f ? static_cast<float>(target.getSize().x) / viewRect.size.x : 0.0f;
+
+	const bool nodesAsPoints = Settings::NODE_SIZE * pixelsPerUnit < Settings::LOD_NODE_POINT_PIXELS;
+	const bool edgesAsLines = Settings::EDGE_THICKNESS * pixelsPerUnit < Settings::LOD_EDGE_LINE_PIXELS;
+	const bool drawArrows = Settings::EDGE_ARROW_SIZE * pixelsPerUnit >= Settings::LOD_ARROW_PIXELS;
+
+	// Edges. Vertices 0-5 are the quad (corners A, B, C, D), 6-8 the arrow.
+	Reserve(m_visibleEdges, edgeBounds.size() * (edgesAsLines ? 2 : 6));
+	Reserve(m_visibleArrows, drawArrows ? edgeBounds.size() * 3 : 0);
+	size_t numOfEdgeVertices = 0;
+	size_t numOfArrowVertices = 0;
+	for (size_t i = 0; i < edgeBounds.size(); ++i)
+	{
+		if (!edgeBounds[i].intersects(visible))
+		{
+			continue;
+		}
+
+		const size_t first = 9 * i;
+		if (edgesAsLines)
+		{
+			// From the middle of A B to the middle of C D.
+			sf::Vertex& start = m_visibleEdges[numOfEdgeVertices++];
+			sf::Vertex& end = m_visibleEdges[numOfEdgeVertices++];
+			start = edgeVertices[first];
+			end = edgeVertices[first + 2];
+			start.position = 0.5f * (edgeVertices[first].position + edgeVertices[first + 1].position);
+			end.position = 0.5f * (edgeVertices[first + 2].position + edgeVertices[first + 3].position);
+		}
+		else
+		{
+			for (size_t k = 0; k < 6; ++k)
+			{
+				m_visibleEdges[numOfEdgeVertices++] = edgeVertices[first + k];
+			}
+		}
+
+		if (drawArrows)
+		{
+			for (size_t k = 6; k < 9; ++k)
+			{
+				m_visibleArrows[numOfArrowVertices++] = edgeVertices[first + k];
+			}
+		}
+	}
+
+	// Nodes. Vertex 0 is the top left corner of the square, vertex 3 the bottom right one.
+	Reserve(m_visibleNodes, nodeBounds.size() * (nodesAsPoints ? 1 : 6));
+	size_t numOfNodeVertices = 0;
+	for (size_t i = 0; i < nodeBounds.size(); ++i)
+	{
+		if (!nodeBounds[i].intersects(visible))
+		{
+			continue;
+		}
+
+		const size_t first = 6 * i;
+		if (nodesAsPoints)
+		{
+			sf::Vertex& point = m_visibleNodes[numOfNodeVertices++];
+			point = nodeVertices[first];
+			point.position = 0.5f * (nodeVertices[first].position + nodeVertices[first + 3].position);
+		}
+		else
+		{
+			for (size_t k = 0; k < 6; ++k)
+			{
+				m_visibleNodes[numOfNodeVertices++] = nodeVertices[first + k];
+			}
+		}
+	}
+
+	if (numOfEdgeVertices > 0)
+	{
+		target.draw(m_visibleEdges.data(), numOfEdgeVertices, edgesAsLines ? sf::PrimitiveType::Lines : sf::PrimitiveType::Triangles, states);
+	}
+	if (numOfArrowVertices > 0)
+	{
+		target.draw(m_visibleArrows.data(), numOfArrowVertices, sf::PrimitiveType::Triangles, states);
+	}
+	if (numOfNodeVertices > 0)
+	{
+		target.draw(m_visibleNodes.data(), numOfNodeVertices, nodesAsPoints ? sf::PrimitiveType::Points : sf::PrimitiveType::Triangles, states);
+	}
+}
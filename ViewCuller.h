@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Draws node and edge vertex arrays laid out like Graph's (6 vertices per node, 9 per edge: a quad and an arrow),
+// sending only what intersects the target's view. Zoomed far out, nodes collapse to points, edges to lines and
+// arrows are dropped, see the LOD thresholds in Settings.
+// Visibility is tested on a compact bounding box per node and edge, so off-screen geometry is never read.
+class ViewCuller
+{
+public:
+	struct Bounds
+	{
+		float minX = 0.0f;
+		float minY = 0.0f;
+		float maxX = 0.0f;
+		float maxY = 0.0f;
+
+		bool intersects(const Bounds& other) const
+		{
+			// Without short-circuiting, the test compiles to straight-line code.
+			return (minX <= other.maxX) & (maxX >= other.minX) & (minY <= other.maxY) & (maxY >= other.minY);
+		}
+	};
+
+	void draw(sf::RenderTarget& target, sf::RenderStates states,
+		const sf::VertexArray& nodeVertices, const std::vector<Bounds>& nodeBounds,
+		const sf::VertexArray& edgeVertices, const std::vector<Bounds>& edgeBounds);
+
+private:
+	// Visible geometry. The buffers only grow and are drawn up to the count of the current frame,
+	// so nothing is allocated or cleared from frame to frame.
+	std::vector<sf::Vertex> m_visibleNodes;
+	std::vector<sf::Vertex> m_visibleEdges;
+	std::vector<sf::Vertex> m_visibleArrows;
+};
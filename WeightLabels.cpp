@@ -0,0 +1,142 @@
+#include "WeightLabels.h"
+#include "Settings.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+	int glyphIndex(char c)
+	{
+		return c == '-' ? 10 : c - '0';
+	}
+}
+
+void WeightLabels::setFont(const sf::Font& font, unsigned int characterSize)
+{
+	m_font = &font;
+	m_characterSize = characterSize;
+
+	// Rasterize the atlas up front. The texture page may grow later, but glyph rectangles stay valid.
+	const char characters[NUM_OF_GLYPHS] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '-' };
+	for (char c : characters)
+	{
+		const sf::Glyph& glyph = font.getGlyph(static_cast<std::uint32_t>(c), characterSize, false);
+		GlyphQuad& quad = m_glyphs[glyphIndex(c)];
+		quad.bounds = glyph.bounds;
+		quad.textureRect = sf::FloatRect{ sf::Vector2f(glyph.textureRect.position), sf::Vector2f(glyph.textureRect.size) };
+		quad.advance = glyph.advance;
+	}
+
+	// Forces a rebuild with the new glyphs.
+	m_pixelSize = 0.0f;
+}
+
+void WeightLabels::update(const std::vector<sf::Vector2f>& positions, const std::vector<int>& weights, float pixelSize)
+{
+	if (!m_font)
+	{
+		return;
+	}
+
+	if (pixelSize != m_pixelSize || positions.size() != m_positions.size())
+	{
+		m_pixelSize = pixelSize;
+		rebuild(positions, weights);
+		return;
+	}
+
+	// Movements below a quarter of a pixel are invisible.
+	const float threshold = 0.25f * pixelSize;
+	const float thresholdSquared = threshold * threshold;
+	char buffer[MAX_LABEL_LENGTH];
+
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		const bool moved = (positions[i] - m_positions[i]).lengthSquared() > thresholdSquared;
+		const bool changed = weights[i] != m_weights[i];
+		if (!moved && !changed)
+		{
+			continue;
+		}
+
+		if (changed)
+		{
+			unsigned int length = static_cast<unsigned int>(std::to_chars(buffer, buffer + MAX_LABEL_LENGTH, weights[i]).ptr - buffer);
+			if (6 * length != m_labelOffsets[i + 1] - m_labelOffsets[i])
+			{
+				rebuild(positions, weights);
+				return;
+			}
+		}
+
+		writeLabel(i, positions[i], weights[i]);
+	}
+}
+
+void WeightLabels::rebuild(const std::vector<sf::Vector2f>& positions, const std::vector<int>& weights)
+{
+	char buffer[MAX_LABEL_LENGTH];
+
+	m_labelOffsets.resize(positions.size() + 1);
+	m_labelOffsets[0] = 0;
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		unsigned int length = static_cast<unsigned int>(std::to_chars(buffer, buffer + MAX_LABEL_LENGTH, weights[i]).ptr - buffer);
+		m_labelOffsets[i + 1] = m_labelOffsets[i] + 6 * length;
+	}
+
+	m_vertices.resize(m_labelOffsets.back());
+	m_positions.resize(positions.size());
+	m_weights.resize(weights.size());
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		writeLabel(i, positions[i], weights[i]);
+	}
+}
+
+void WeightLabels::writeLabel(size_t label, sf::Vector2f position, int weight)
+{
+	m_positions[label] = position;
+	m_weights[label] = weight;
+
+	char buffer[MAX_LABEL_LENGTH];
+	char* end = std::to_chars(buffer, buffer + MAX_LABEL_LENGTH, weight).ptr;
+
+	// Same layout as sf::Text: the baseline of the first line sits characterSize pixels below the top.
+	float penX = 0.0f;
+	const float baseline = static_cast<float>(m_characterSize);
+	unsigned int vertex = m_labelOffsets[label];
+
+	for (char* c = buffer; c != end; ++c)
+	{
+		const GlyphQuad& glyph = m_glyphs[glyphIndex(*c)];
+
+		sf::Vector2f topLeft = position + m_pixelSize * sf::Vector2f{ penX + glyph.bounds.position.x, baseline + glyph.bounds.position.y };
+		sf::Vector2f size = m_pixelSize * glyph.bounds.size;
+		sf::Vector2f texTopLeft = glyph.textureRect.position;
+		sf::Vector2f texSize = glyph.textureRect.size;
+
+		const sf::Vector2f corners[6] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 1 } };
+		for (int k = 0; k < 6; ++k)
+		{
+			sf::Vertex& v = m_vertices[vertex + k];
+			v.position = topLeft + sf::Vector2f{ corners[k].x * size.x, corners[k].y * size.y };
+			v.texCoords = texTopLeft + sf::Vector2f{ corners[k].x * texSize.x, corners[k].y * texSize.y };
+			v.color = Settings::FONT_COLOR;
+		}
+
+		vertex += 6;
+		penX += glyph.advance;
+	}
+}
+
+void WeightLabels::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	if (!m_font || m_vertices.getVertexCount() == 0)
+	{
+		return;
+	}
+	states.texture = &m_font->getTexture(m_characterSize);
+	target.draw(m_vertices, states);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Edge weight labels drawn as one vertex array of textured quads in a single draw call.
+// The glyphs of the digits and the minus sign are rasterized once into the font's texture page
+// for the label size, every label is then just a few quads pointing into that atlas.
+// Quads live in world coordinates and are scaled so that the text keeps a constant size on screen.
+class WeightLabels : public sf::Drawable
+{
+public:
+	void setFont(const sf::Font& font, unsigned int characterSize);
+
+	// Labels are placed with their top-left at positions (world coordinates). pixelSize is the size of one
+	// screen pixel in world units. Only labels that moved by more than a fraction of a pixel or whose
+	// weight changed are rewritten, a zoom or a change in the number of digits rebuilds everything.
+	void update(const std::vector<sf::Vector2f>& positions, const std::vector<int>& weights, float pixelSize);
+
+private:
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+	void rebuild(const std::vector<sf::Vector2f>& positions, const std::vector<int>& weights);
+	void writeLabel(size_t label, sf::Vector2f position, int weight);
+
+	struct GlyphQuad
+	{
+		sf::FloatRect bounds;		// Relative to the pen position on the baseline, in pixels.
+		sf::FloatRect textureRect;
+		float advance = 0.0f;
+	};
+
+	static constexpr int NUM_OF_GLYPHS = 11;	// '0' - '9' and '-'.
+	static constexpr int MAX_LABEL_LENGTH = 11;	// "-2147483648"
+
+	const sf::Font* m_font = nullptr;
+	unsigned int m_characterSize = 0;
+	GlyphQuad m_glyphs[NUM_OF_GLYPHS];
+
+	sf::VertexArray m_vertices{ sf::PrimitiveType::Triangles };
+	std::vector<unsigned int> m_labelOffsets;	// First vertex of every label, 6 vertices per character.
+	std::vector<sf::Vector2f> m_positions;		// What the quads were last written for.
+	std::vector<int> m_weights;
+	float m_pixelSize = 0.0f;
+};